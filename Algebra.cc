@@ -4,7 +4,8 @@ int Algebra::mod(int a, size_t Zp)
 {
 	if (a < 0)
 	{
-		return Zp - (-a) % Zp;
+		size_t r = size_t(-static_cast<long long>(a)) % Zp;
+		return r ? int(Zp - r) : 0;
 	}
 	else
 	{
@@ -12,6 +13,27 @@ int Algebra::mod(int a, size_t Zp)
 	}
 }
 
+size_t Algebra::mulmod(size_t a, size_t b, size_t Zp)
+{
+#if defined(__SIZEOF_INT128__)
+	return size_t(static_cast<unsigned __int128>(a) * b % Zp);
+#else
+	if (!mulhi(a, b))
+		return size_t(uint64_t(a) * b % Zp);
+	// double-and-add, no intermediate value exceeds Zp
+	auto add = [Zp](size_t x, size_t y) { return x >= Zp - y ? x - (Zp - y) : x + y; };
+	size_t res = 0;
+	a %= Zp;
+	for (; b; b >>= 1)
+	{
+		if (b & 1)
+			res = add(res, a);
+		a = add(a, a);
+	}
+	return res;
+#endif
+}
+
 std::vector<int> Algebra::normalize(const std::vector<int>& vec, size_t Zp)
 {
 	std::vector<int> res(vec);
@@ -25,12 +47,16 @@ int Algebra::randmod(std::function<int()> generator, size_t Zp)
 	return mod(generator(), Zp);
 }
 
-size_t Algebra::powmod(int a, size_t pow, size_t Zp)
+size_t Algebra::powmod(long long a, size_t pow, size_t Zp)
 {
-	size_t res = 1;
-	while (pow--)
+	size_t res = 1 % Zp, base = a < 0 ? (Zp - size_t(-(a + 1)) % Zp - 1) % Zp : size_t(a) % Zp;
+	// right-to-left square-and-multiply
+	for (; pow; pow >>= 1)
 	{
-		res = mod(res * a, Zp);
+		if (pow & 1)
+			res = mulmod(res, base, Zp);
+		if (pow > 1)
+			base = mulmod(base, base, Zp);
 	}
 
 	return res;
@@ -59,8 +85,8 @@ size_t Algebra::gcd(size_t a, size_t b)
 
 size_t Algebra::expanded_gcd(size_t a, size_t b, size_t Zp)
 {
-	a = mod(a, Zp);
-	b = mod(b, Zp);
+	a %= Zp;
+	b %= Zp;
 	if (a == 1)
 		return b;
 	auto g = gcd(a, Zp);
@@ -75,21 +101,27 @@ size_t Algebra::expanded_gcd(size_t a, size_t b, size_t Zp)
 			Zp /= g;
 		}
 	}
-	std::array<std::array<int, 4>, 2> matrix = {{{0, Zp, 1, 0},{0, a, 0, 1}}};
+	// Bezout coefficients are kept modulo Zp, so nothing overflows for any Zp
+	auto submul = [Zp](size_t x, size_t q, size_t y)
+	{
+		size_t qy = mulmod(q % Zp, y, Zp);
+		return x >= qy ? x - qy : x + (Zp - qy);
+	};
+	std::array<std::array<size_t, 4>, 2> matrix = {{{0, Zp, 1 % Zp, 0},{0, a, 0, 1 % Zp}}};
 	while (matrix[1][1] != 1)
 	{
-		int q_i = matrix[0][1] / matrix[1][1]; // q_i = r_i-2 / r_i-1
-		std::array<int, 4> temp = {
+		size_t q_i = matrix[0][1] / matrix[1][1]; // q_i = r_i-2 / r_i-1
+		std::array<size_t, 4> temp = {
 			q_i,
 			matrix[0][1] % matrix[1][1], // r_i = r_i-2 mod r_i-1
-			matrix[0][2] - q_i * matrix[1][2], // x_i = x_i-2 - q_i-1*x_i-1
-			matrix[0][3] - q_i * matrix[1][3] // y_i = y_i-2 - q_i-1*y_i-1
+			submul(matrix[0][2], q_i, matrix[1][2]), // x_i = x_i-2 - q_i-1*x_i-1
+			submul(matrix[0][3], q_i, matrix[1][3]) // y_i = y_i-2 - q_i-1*y_i-1
 		};
 
 		matrix[0] = matrix[1]; // shift up
 		matrix[1] = temp;
 	}
-	return mod(matrix[1][3] * b, Zp);
+	return mulmod(matrix[1][3], b, Zp);
 }
 
 size_t Algebra::inverse_mod(size_t a, size_t Zp)
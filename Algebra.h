@@ -2,17 +2,46 @@
 #include <array>
 #include <vector>
 #include <functional>
+#include <cstddef>
+#include <cstdint>
 
 namespace Algebra
 {
+	// High 64 bits of the 128-bit product a * b
+	constexpr uint64_t mulhi(uint64_t a, uint64_t b)
+	{
+#if defined(__SIZEOF_INT128__)
+		return uint64_t(static_cast<unsigned __int128>(a) * b >> 64);
+#else
+		return (a >> 32) * (b >> 32) + ((a >> 32) * (b & 0xFFFFFFFF) >> 32) + ((a & 0xFFFFFFFF) * (b >> 32) >> 32) +
+			(((a & 0xFFFFFFFF) * (b & 0xFFFFFFFF) >> 32) + ((a >> 32) * (b & 0xFFFFFFFF) & 0xFFFFFFFF) + ((a & 0xFFFFFFFF) * (b >> 32) & 0xFFFFFFFF) >> 32);
+#endif
+	}
+
 	int mod(int a, size_t Zp);
 
+	// a * b mod Zp without overflow for any Zp
+	size_t mulmod(size_t a, size_t b, size_t Zp);
+
 	std::vector<int> normalize(const std::vector<int>& vec, size_t Zp);
 
 	int randmod(std::function<int()> generator, size_t Zp);
 
-	size_t powmod(int a, size_t pow, size_t Zp);
+	// a^pow mod Zp by square-and-multiply: O(log pow) multiplications
+	size_t powmod(long long a, size_t pow, size_t Zp);
+
+
+	// Trial division, the recursion is sqrt(n) deep: meant for small n known at compile time
+	constexpr bool is_prime(size_t n, size_t divisor = 2)
+	{
+		return n < 2 ? false : divisor * divisor > n ? true : n % divisor == 0 ? false : is_prime(n, divisor + 1);
+	}
 
+	// base^exp, or limit + 1 once it goes above limit
+	constexpr size_t bounded_power(size_t base, size_t exp, size_t limit, size_t acc = 1)
+	{
+		return exp == 0 ? acc : acc > limit / base ? limit + 1 : bounded_power(base, exp - 1, limit, acc * base);
+	}
 
 	// GCD(a, b) = GCD(b, b % a)
 	size_t gcd(size_t a, size_t b);
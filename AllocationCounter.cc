@@ -0,0 +1,30 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// the replacements live apart from their callers: inlined into them GCC reports every free() of a new'd pointer
+static std::atomic<size_t> allocations(0);
+
+size_t allocation_count()
+{
+	return allocations;
+}
+
+void* operator new(size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	std::free(p);
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <cstddef>
+
+
+// Heap allocations of the whole program so far. AllocationCounter.cc replaces the global operator new and
+// operator delete, so it is linked only into programs which read the count (the examples)
+size_t allocation_count();
@@ -0,0 +1,195 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include "Polynomial.h"
+
+
+namespace Algebra
+{
+	// Polynomial over GF(2), coefficients are packed 64 per machine word.
+	// Addition is XOR, multiplication uses carry-less multiply (PCLMULQDQ when CPU supports it).
+	// Public interface is identical to the generic Polynomial<Zp>.
+	template <>
+	class Polynomial<2> {
+		typedef std::vector<uint64_t> wvec;
+
+		static const size_t WordBits = 64;
+
+		// bit i of the packed array is the coefficient of x^i
+		wvec words;
+		// number of coefficients, deg() + 1: the highest bit is always set unless the polynomial is zero
+		size_t length;
+
+		static size_t	WordsFor		(size_t bits);
+		static size_t	HighestBit		(uint64_t word);
+
+		// res ^= a * b, res must have na + nb words (zeroed for the plain product)
+		static void		MultiplyWords	(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* res);
+		// dst ^= src << shift, bits shifted past dst_words are dropped
+		static void		XorShifted		(uint64_t* dst, size_t dst_words, const uint64_t* src, size_t src_words, size_t shift);
+
+		void			resize			(size_t new_length);
+		// drops high zero coefficients, every mutation ends with it
+		void			normalize		();
+	protected:
+		explicit Polynomial				(size_t length);
+
+	public:
+		// squaring is a spread of bits, see square()
+		static const bool							SpreadPowers = true;
+		static OUTPUT_MODE							OutputMode;
+		static DIVISION_CORRUPTION_POLICY			DivisionPolicy;
+		static const Polynomial						One;
+		static const Polynomial						X;
+		static const Polynomial						Zero;
+
+
+		Polynomial						(const std::initializer_list<int>& l);
+		Polynomial						(const std::vector<int>& powers);
+
+		Polynomial						(const Polynomial& p) = default;
+		// moves only hand over the word buffer
+		Polynomial						(Polynomial&& p) noexcept = default;
+		Polynomial&		operator =		(const Polynomial& p) = default;
+		Polynomial&		operator =		(Polynomial&& p) noexcept = default;
+
+		//// CONTROL FUNCTIONS AND OPERATORS
+
+		size_t			size()										const;
+
+		size_t			operator[]		(size_t idx)				const;
+
+
+		void			assign			(const std::vector<int>& p);
+		void			set				(size_t idx, long long value);
+
+		// O(n/64)
+		size_t			eval			(int x_value)				const;
+		// the only points are 0 and 1, every one is an eval()
+		std::vector<size_t>	eval_many	(const std::vector<size_t>& points) const;
+
+		// O(1)
+		size_t			deg				()							const;
+
+		//// ALGEBRAIC FUNCTIONS AND OPERATORS
+
+		Polynomial		derivative		()							const;
+		Polynomial		shift_back		(size_t shift)				const;
+
+		// O(n/64)
+		Polynomial		shift(size_t shift)				const;
+		/////// ARITHMETIC
+
+		// XOR: O(n/64); the rvalue versions reuse the left operand's words
+		Polynomial&		operator +=		(const Polynomial& p);
+		Polynomial		operator +		(const Polynomial& p)		const &;
+		Polynomial		operator +		(const Polynomial& p)		&&;
+
+		// same as addition in characteristic 2
+		Polynomial&		operator -=		(const Polynomial& p);
+		Polynomial		operator -		(const Polynomial& p)		const &;
+		Polynomial		operator -		(const Polynomial& p)		&&;
+
+		// O((n/64)^2) carry-less multiplications
+		Polynomial&		operator *=		(const Polynomial& p);
+		Polynomial&		operator *=		(Polynomial&& p);
+		Polynomial		operator *		(const Polynomial& p)		const &;
+		Polynomial		operator *		(const Polynomial& p)		&&;
+		// Just constant multiplication: the parity of number decides, O(n/64)
+		Polynomial&		operator *=		(long long number);
+		Polynomial		operator *		(long long number)			const &;
+		Polynomial		operator *		(long long number)			&&;
+		// this += a * b: the carry-less products are XORed straight into this words, submul is the same
+		Polynomial&		addmul			(const Polynomial& a, const Polynomial& b);
+		Polynomial&		submul			(const Polynomial& a, const Polynomial& b);
+		// Spreads bit i to bit 2i: O(n/64), no multiplication at all
+		Polynomial		square			()							const;
+		// this(x^(2^k)) = this^(2^k) by k spreads
+		Polynomial		frobenius		(size_t k)					const;
+		// *-1, which is identity in GF(2)
+		Polynomial		negate()									const &;
+		Polynomial		negate()									&&;
+
+
+		std::pair<Polynomial, Polynomial> divide(const Polynomial& p)const;
+		Polynomial		operator %		(const Polynomial& p)		const;
+		Polynomial&		operator %=		(const Polynomial& p);
+		Polynomial		operator /		(const Polynomial& p)		const;
+		Polynomial&		operator /=		(const Polynomial& p);
+
+		void			swap			(Polynomial& p)				noexcept;
+
+		// Sliding window: log2(power) squarings and about log2(power) / w other multiplications
+		Polynomial		pow				(size_t power)				const;
+
+
+		//////// LOGICAL
+
+		bool			operator ==		(const Polynomial& p)		const;
+		bool			operator !=		(const Polynomial& p)		const;
+
+		bool			operator <		(const Polynomial& p)		const;
+		bool			operator >		(const Polynomial& p)		const;
+
+		// FNV-1a over the coefficients, std::hash goes through it
+		size_t			hash			()							const;
+
+
+
+		//// OUTPUT
+
+		friend std::ostream& operator << (std::ostream &s, const Polynomial &p) {
+			const size_t last_index = p.size() - 1;
+
+			bool printed = false;
+			for (size_t i = last_index; i != size_t(-1); --i) {
+				if (p[i] != 0 || OutputMode == OUTPUT_MODE::CANONICAL)
+				{
+					// insert operator only AFTER the first (thus, we are sure, that this operator is needed)
+					if (printed)
+					{
+						s << " + ";
+					}
+					if (i == 0 || p[i] != 1)
+						s << p[i];
+
+					if (i == 1) {
+						s << "x";
+					}
+					else if (i > 1) { // i > 1
+						s << "x^" << i;
+					}
+					printed = true;
+				}
+			}
+			if (!printed)
+				s << "0";
+			return s;
+		}
+
+		static Polynomial	Gcd			(const Polynomial& p1, const Polynomial& p2);
+		static Polynomial	ExpandedGcd	(Polynomial a, Polynomial b, Polynomial mod);
+
+		// base^exponent mod modulus: sliding window with reduction after every product, O(deg modulus) memory
+		static Polynomial	PowMod		(const Polynomial& base, size_t exponent, const Polynomial& modulus);
+		// a * b mod modulus
+		static Polynomial	MulMod		(const Polynomial& a, const Polynomial& b, const Polynomial& modulus);
+		// base^(2^n) mod modulus by n squarings
+		static Polynomial	FrobeniusMod(const Polynomial& base, size_t n, const Polynomial& modulus);
+
+		// Poly : x^(2^n) - x mod f(x)
+		// Computed by FrobeniusMod, never builds x^(2^n) itself
+		static Polynomial SpecialPolyMod(size_t n, const Polynomial& modpoly);
+
+		// at most the two points 0 and 1, see SubproductTree
+		static Polynomial	Interpolate	(const std::vector<size_t>& points, const std::vector<size_t>& values);
+	};
+}
+
+// Both instantiate Polynomial<2>, so they follow the specialization even when this header is included first:
+// fixed modulus with precomputed reciprocal, PowMod and FrobeniusMod go through it
+#include "PolynomialModulus.h"
+// multipoint evaluation and interpolation
+#include "SubproductTree.h"
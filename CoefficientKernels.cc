@@ -0,0 +1,788 @@
+#include "CoefficientKernels.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define ALGEBRA_X86
+#define ALGEBRA_TARGET_AVX2
+#define ALGEBRA_TARGET_AVX512
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ALGEBRA_X86
+#define ALGEBRA_TARGET_AVX2 __attribute__((target("avx2")))
+#define ALGEBRA_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#endif
+
+namespace Algebra
+{
+	/////////////// CONSTANT DEFINTION
+
+	SIMD_LEVEL CoefficientKernels::Level = SIMD_LEVEL::AUTO;
+
+	/////////////// PORTABLE KERNELS
+
+	// every kernel below works on a[0 .. n), the vector ones return how many leading elements they have done
+
+	template <class S>
+	static void add_portable(S* a, const S* b, size_t n, uint64_t m)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			uint64_t x = a[i], y = b[i];
+			a[i] = S(x >= m - y ? x - (m - y) : x + y);
+		}
+	}
+
+	template <class S>
+	static void sub_portable(S* a, const S* b, size_t n, uint64_t m)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			uint64_t x = a[i], y = b[i];
+			a[i] = S(x >= y ? x - y : x + (m - y));
+		}
+	}
+
+	template <class S>
+	static void negate_portable(S* a, size_t n, uint64_t m)
+	{
+		for (size_t i = 0; i < n; ++i)
+			a[i] = S(a[i] ? m - a[i] : 0);
+	}
+
+	// Shoup: q = floor(x * floor(c * 2^32 / m) / 2^32) is at most one less than floor(x * c / m)
+	template <class S>
+	static void scale_portable(S* a, size_t n, uint64_t c, uint64_t m)
+	{
+		const uint64_t shoup = (c << 32) / m;
+		for (size_t i = 0; i < n; ++i)
+		{
+			uint64_t x = a[i], r = x * c - (x * shoup >> 32) * m;
+			a[i] = S(r >= m ? r - m : r);
+		}
+	}
+
+	// polynomials [begin, n) one at a time, Shoup's quotient for every x
+	template <class S>
+	static void has_root_portable(const S* a, size_t stride, size_t degree, size_t begin, size_t n, uint64_t m, uint64_t* roots)
+	{
+		for (size_t j = begin; j < n; ++j)
+		{
+			bool root = false;
+			for (uint64_t x = 0; x < m && !root; ++x)
+			{
+				const uint64_t shoup = (x << 32) / m;
+				uint64_t value = a[degree * stride + j];
+				for (size_t i = degree; i-- > 0;)
+				{
+					uint64_t r = value * x - (value * shoup >> 32) * m;
+					r = (r >= m ? r - m : r) + a[i * stride + j];
+					value = r >= m ? r - m : r;
+				}
+				root = value == 0;
+			}
+			if (root)
+				roots[j / 64] |= uint64_t(1) << (j % 64);
+		}
+	}
+
+#ifdef ALGEBRA_X86
+	/////////////// AVX2 KERNELS
+
+	// lanes of one width: set1, add, sub, unsigned min and comparison
+	struct Avx2Lanes8
+	{
+		typedef uint8_t scalar;
+		typedef __m256i mask;
+		static const size_t Count = 32;
+		ALGEBRA_TARGET_AVX2 static __m256i	set	(uint64_t v)			{ return _mm256_set1_epi8(char(v)); }
+		ALGEBRA_TARGET_AVX2 static __m256i	add	(__m256i a, __m256i b)	{ return _mm256_add_epi8(a, b); }
+		ALGEBRA_TARGET_AVX2 static __m256i	sub	(__m256i a, __m256i b)	{ return _mm256_sub_epi8(a, b); }
+		ALGEBRA_TARGET_AVX2 static __m256i	min	(__m256i a, __m256i b)	{ return _mm256_min_epu8(a, b); }
+		// all ones where a >= b
+		ALGEBRA_TARGET_AVX2 static mask		ge	(__m256i a, __m256i b)	{ return _mm256_cmpeq_epi8(_mm256_max_epu8(a, b), a); }
+		ALGEBRA_TARGET_AVX2 static __m256i	select(mask k, __m256i x, __m256i y)	{ return _mm256_blendv_epi8(y, x, k); }
+	};
+
+	struct Avx2Lanes16
+	{
+		typedef uint16_t scalar;
+		typedef __m256i mask;
+		static const size_t Count = 16;
+		ALGEBRA_TARGET_AVX2 static __m256i	set	(uint64_t v)			{ return _mm256_set1_epi16(short(v)); }
+		ALGEBRA_TARGET_AVX2 static __m256i	add	(__m256i a, __m256i b)	{ return _mm256_add_epi16(a, b); }
+		ALGEBRA_TARGET_AVX2 static __m256i	sub	(__m256i a, __m256i b)	{ return _mm256_sub_epi16(a, b); }
+		ALGEBRA_TARGET_AVX2 static __m256i	min	(__m256i a, __m256i b)	{ return _mm256_min_epu16(a, b); }
+		ALGEBRA_TARGET_AVX2 static mask		ge	(__m256i a, __m256i b)	{ return _mm256_cmpeq_epi16(_mm256_max_epu16(a, b), a); }
+		ALGEBRA_TARGET_AVX2 static __m256i	select(mask k, __m256i x, __m256i y)	{ return _mm256_blendv_epi8(y, x, k); }
+	};
+
+	struct Avx2Lanes32
+	{
+		typedef uint32_t scalar;
+		typedef __m256i mask;
+		static const size_t Count = 8;
+		ALGEBRA_TARGET_AVX2 static __m256i	set	(uint64_t v)			{ return _mm256_set1_epi32(int(v)); }
+		ALGEBRA_TARGET_AVX2 static __m256i	add	(__m256i a, __m256i b)	{ return _mm256_add_epi32(a, b); }
+		ALGEBRA_TARGET_AVX2 static __m256i	sub	(__m256i a, __m256i b)	{ return _mm256_sub_epi32(a, b); }
+		ALGEBRA_TARGET_AVX2 static __m256i	min	(__m256i a, __m256i b)	{ return _mm256_min_epu32(a, b); }
+		ALGEBRA_TARGET_AVX2 static mask		ge	(__m256i a, __m256i b)	{ return _mm256_cmpeq_epi32(_mm256_max_epu32(a, b), a); }
+		ALGEBRA_TARGET_AVX2 static __m256i	select(mask k, __m256i x, __m256i y)	{ return _mm256_blendv_epi8(y, x, k); }
+	};
+
+	ALGEBRA_TARGET_AVX2 static __m256i load_avx2(const void* p)
+	{
+		return _mm256_loadu_si256(static_cast<const __m256i*>(p));
+	}
+
+	ALGEBRA_TARGET_AVX2 static void store_avx2(void* p, __m256i v)
+	{
+		_mm256_storeu_si256(static_cast<__m256i*>(p), v);
+	}
+
+	// x mod m for x < 2m: min(x, x - m) as unsigned numbers
+	template <class L>
+	ALGEBRA_TARGET_AVX2 static __m256i reduce_avx2(__m256i x, __m256i m)
+	{
+		return L::min(x, L::sub(x, m));
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX2 static size_t add_avx2(typename L::scalar* a, const typename L::scalar* b, size_t n, uint64_t m)
+	{
+		const __m256i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+			store_avx2(a + i, reduce_avx2<L>(L::add(load_avx2(a + i), load_avx2(b + i)), vm));
+		return i;
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX2 static size_t sub_avx2(typename L::scalar* a, const typename L::scalar* b, size_t n, uint64_t m)
+	{
+		const __m256i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+		{
+			// a - b wraps around below zero, a - b + m is the residue then
+			__m256i d = L::sub(load_avx2(a + i), load_avx2(b + i));
+			store_avx2(a + i, L::min(d, L::add(d, vm)));
+		}
+		return i;
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX2 static size_t negate_avx2(typename L::scalar* a, size_t n, uint64_t m)
+	{
+		const __m256i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+			store_avx2(a + i, reduce_avx2<L>(L::sub(vm, load_avx2(a + i)), vm));
+		return i;
+	}
+
+	// m above 2^(bits - 1): sums wrap around the word, so the reduction compares the operands instead
+	template <class L>
+	ALGEBRA_TARGET_AVX2 static size_t add_wide_avx2(typename L::scalar* a, const typename L::scalar* b, size_t n, uint64_t m)
+	{
+		const __m256i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+		{
+			// a + b >= m exactly when a >= m - b
+			__m256i x = load_avx2(a + i), y = load_avx2(b + i), complement = L::sub(vm, y);
+			store_avx2(a + i, L::select(L::ge(x, complement), L::sub(x, complement), L::add(x, y)));
+		}
+		return i;
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX2 static size_t sub_wide_avx2(typename L::scalar* a, const typename L::scalar* b, size_t n, uint64_t m)
+	{
+		const __m256i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+		{
+			__m256i x = load_avx2(a + i), y = load_avx2(b + i), d = L::sub(x, y);
+			store_avx2(a + i, L::select(L::ge(x, y), d, L::add(d, vm)));
+		}
+		return i;
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX2 static size_t negate_wide_avx2(typename L::scalar* a, size_t n, uint64_t m)
+	{
+		const __m256i vm = L::set(m), one = L::set(1), zero = L::sub(vm, vm);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+		{
+			__m256i x = load_avx2(a + i);
+			store_avx2(a + i, L::select(L::ge(x, one), L::sub(vm, x), zero));
+		}
+		return i;
+	}
+
+	// 16-bit Shoup step on 16 lanes, x < 2^16
+	ALGEBRA_TARGET_AVX2 static __m256i scale16_avx2(__m256i x, __m256i c, __m256i shoup, __m256i m)
+	{
+		__m256i q = _mm256_mulhi_epu16(x, shoup);
+		__m256i r = _mm256_sub_epi16(_mm256_mullo_epi16(x, c), _mm256_mullo_epi16(q, m));
+		return reduce_avx2<Avx2Lanes16>(r, m);
+	}
+
+	ALGEBRA_TARGET_AVX2 static size_t scale_avx2(uint8_t* a, size_t n, uint64_t c, uint64_t m)
+	{
+		const __m256i vc = _mm256_set1_epi16(short(c)), vs = _mm256_set1_epi16(short((c << 16) / m)), vm = _mm256_set1_epi16(short(m));
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+		{
+			// widen 16 bytes to words and pack the residues back
+			__m256i x = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+			__m256i r = scale16_avx2(x, vc, vs, vm);
+			__m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), packed);
+		}
+		return i;
+	}
+
+	ALGEBRA_TARGET_AVX2 static size_t scale_avx2(uint16_t* a, size_t n, uint64_t c, uint64_t m)
+	{
+		const __m256i vc = _mm256_set1_epi16(short(c)), vs = _mm256_set1_epi16(short((c << 16) / m)), vm = _mm256_set1_epi16(short(m));
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+			store_avx2(a + i, scale16_avx2(load_avx2(a + i), vc, vs, vm));
+		return i;
+	}
+
+	// 32-bit Shoup step on 8 lanes
+	ALGEBRA_TARGET_AVX2 static __m256i scale32_avx2(__m256i x, __m256i c, __m256i shoup, __m256i m)
+	{
+		// high halves of x * shoup: even lanes by one 32x32 -> 64 multiply, odd lanes by another
+		__m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, shoup), 32);
+		__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), shoup);
+		__m256i q = _mm256_blend_epi32(even, odd, 0xAA);
+		__m256i r = _mm256_sub_epi32(_mm256_mullo_epi32(x, c), _mm256_mullo_epi32(q, m));
+		return reduce_avx2<Avx2Lanes32>(r, m);
+	}
+
+	ALGEBRA_TARGET_AVX2 static size_t scale_avx2(uint32_t* a, size_t n, uint64_t c, uint64_t m)
+	{
+		const __m256i vc = _mm256_set1_epi32(int(c)), vs = _mm256_set1_epi32(int((c << 32) / m)), vm = _mm256_set1_epi32(int(m));
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			store_avx2(a + i, scale32_avx2(load_avx2(a + i), vc, vs, vm));
+		return i;
+	}
+
+	// 16 coefficients as 16-bit lanes
+	ALGEBRA_TARGET_AVX2 static __m256i widen16_avx2(const uint8_t* p)
+	{
+		return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+	}
+
+	ALGEBRA_TARGET_AVX2 static __m256i widen16_avx2(const uint16_t* p)
+	{
+		return load_avx2(p);
+	}
+
+	// bytes and words in 16-bit lanes, 16 polynomials at a time
+	template <class S>
+	ALGEBRA_TARGET_AVX2 static size_t has_root16_avx2(const S* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		const __m256i vm = _mm256_set1_epi16(short(m)), zero = _mm256_sub_epi32(vm, vm);
+		size_t j = 0;
+		for (; j + 16 <= n; j += 16)
+		{
+			uint32_t found = 0;
+			for (uint64_t x = 0; x < m && found != 0xFFFF; ++x)
+			{
+				const __m256i vx = _mm256_set1_epi16(short(x)), vs = _mm256_set1_epi16(short((x << 16) / m));
+				__m256i value = widen16_avx2(a + degree * stride + j);
+				for (size_t i = degree; i-- > 0;)
+					value = reduce_avx2<Avx2Lanes16>(_mm256_add_epi16(scale16_avx2(value, vx, vs, vm), widen16_avx2(a + i * stride + j)), vm);
+				// one bit per lane: the comparison words packed to bytes
+				__m256i zeros = _mm256_cmpeq_epi16(value, zero);
+				found |= uint32_t(_mm_movemask_epi8(_mm_packs_epi16(_mm256_castsi256_si128(zeros), _mm256_extracti128_si256(zeros, 1))));
+			}
+			roots[j / 64] |= uint64_t(found) << (j % 64);
+		}
+		return j;
+	}
+
+	ALGEBRA_TARGET_AVX2 static size_t has_root32_avx2(const uint32_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		const __m256i vm = _mm256_set1_epi32(int(m)), zero = _mm256_sub_epi32(vm, vm);
+		size_t j = 0;
+		for (; j + 8 <= n; j += 8)
+		{
+			uint32_t found = 0;
+			for (uint64_t x = 0; x < m && found != 0xFF; ++x)
+			{
+				const __m256i vx = _mm256_set1_epi32(int(x)), vs = _mm256_set1_epi32(int((x << 32) / m));
+				__m256i value = load_avx2(a + degree * stride + j);
+				for (size_t i = degree; i-- > 0;)
+					value = reduce_avx2<Avx2Lanes32>(_mm256_add_epi32(scale32_avx2(value, vx, vs, vm), load_avx2(a + i * stride + j)), vm);
+				found |= uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(value, zero))));
+			}
+			roots[j / 64] |= uint64_t(found) << (j % 64);
+		}
+		return j;
+	}
+
+	ALGEBRA_TARGET_AVX2 static size_t has_root_avx2(const uint8_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		return has_root16_avx2(a, stride, degree, n, m, roots);
+	}
+
+	ALGEBRA_TARGET_AVX2 static size_t has_root_avx2(const uint16_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		return has_root16_avx2(a, stride, degree, n, m, roots);
+	}
+
+	ALGEBRA_TARGET_AVX2 static size_t has_root_avx2(const uint32_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		return has_root32_avx2(a, stride, degree, n, m, roots);
+	}
+
+	/////////////// AVX-512 KERNELS
+
+	// GCC 12: _mm512_undefined_* in avx512fintrin.h and avx512bwintrin.h reads itself and warns wherever it is inlined
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+	struct Avx512Lanes8
+	{
+		typedef uint8_t scalar;
+		typedef __mmask64 mask;
+		static const size_t Count = 64;
+		ALGEBRA_TARGET_AVX512 static __m512i	set	(uint64_t v)			{ return _mm512_set1_epi8(char(v)); }
+		ALGEBRA_TARGET_AVX512 static __m512i	add	(__m512i a, __m512i b)	{ return _mm512_add_epi8(a, b); }
+		ALGEBRA_TARGET_AVX512 static __m512i	sub	(__m512i a, __m512i b)	{ return _mm512_sub_epi8(a, b); }
+		ALGEBRA_TARGET_AVX512 static __m512i	min	(__m512i a, __m512i b)	{ return _mm512_min_epu8(a, b); }
+		ALGEBRA_TARGET_AVX512 static mask		ge	(__m512i a, __m512i b)	{ return _mm512_cmpge_epu8_mask(a, b); }
+		ALGEBRA_TARGET_AVX512 static __m512i	select(mask k, __m512i x, __m512i y)	{ return _mm512_mask_blend_epi8(k, y, x); }
+	};
+
+	struct Avx512Lanes16
+	{
+		typedef uint16_t scalar;
+		typedef __mmask32 mask;
+		static const size_t Count = 32;
+		ALGEBRA_TARGET_AVX512 static __m512i	set	(uint64_t v)			{ return _mm512_set1_epi16(short(v)); }
+		ALGEBRA_TARGET_AVX512 static __m512i	add	(__m512i a, __m512i b)	{ return _mm512_add_epi16(a, b); }
+		ALGEBRA_TARGET_AVX512 static __m512i	sub	(__m512i a, __m512i b)	{ return _mm512_sub_epi16(a, b); }
+		ALGEBRA_TARGET_AVX512 static __m512i	min	(__m512i a, __m512i b)	{ return _mm512_min_epu16(a, b); }
+		ALGEBRA_TARGET_AVX512 static mask		ge	(__m512i a, __m512i b)	{ return _mm512_cmpge_epu16_mask(a, b); }
+		ALGEBRA_TARGET_AVX512 static __m512i	select(mask k, __m512i x, __m512i y)	{ return _mm512_mask_blend_epi16(k, y, x); }
+	};
+
+	struct Avx512Lanes32
+	{
+		typedef uint32_t scalar;
+		typedef __mmask16 mask;
+		static const size_t Count = 16;
+		ALGEBRA_TARGET_AVX512 static __m512i	set	(uint64_t v)			{ return _mm512_set1_epi32(int(v)); }
+		ALGEBRA_TARGET_AVX512 static __m512i	add	(__m512i a, __m512i b)	{ return _mm512_add_epi32(a, b); }
+		ALGEBRA_TARGET_AVX512 static __m512i	sub	(__m512i a, __m512i b)	{ return _mm512_sub_epi32(a, b); }
+		ALGEBRA_TARGET_AVX512 static __m512i	min	(__m512i a, __m512i b)	{ return _mm512_min_epu32(a, b); }
+		ALGEBRA_TARGET_AVX512 static mask		ge	(__m512i a, __m512i b)	{ return _mm512_cmpge_epu32_mask(a, b); }
+		ALGEBRA_TARGET_AVX512 static __m512i	select(mask k, __m512i x, __m512i y)	{ return _mm512_mask_blend_epi32(k, y, x); }
+	};
+
+	ALGEBRA_TARGET_AVX512 static __m512i load_avx512(const void* p)
+	{
+		return _mm512_loadu_si512(p);
+	}
+
+	ALGEBRA_TARGET_AVX512 static void store_avx512(void* p, __m512i v)
+	{
+		_mm512_storeu_si512(p, v);
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX512 static __m512i reduce_avx512(__m512i x, __m512i m)
+	{
+		return L::min(x, L::sub(x, m));
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX512 static size_t add_avx512(typename L::scalar* a, const typename L::scalar* b, size_t n, uint64_t m)
+	{
+		const __m512i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+			store_avx512(a + i, reduce_avx512<L>(L::add(load_avx512(a + i), load_avx512(b + i)), vm));
+		return i;
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX512 static size_t sub_avx512(typename L::scalar* a, const typename L::scalar* b, size_t n, uint64_t m)
+	{
+		const __m512i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+		{
+			__m512i d = L::sub(load_avx512(a + i), load_avx512(b + i));
+			store_avx512(a + i, L::min(d, L::add(d, vm)));
+		}
+		return i;
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX512 static size_t negate_avx512(typename L::scalar* a, size_t n, uint64_t m)
+	{
+		const __m512i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+			store_avx512(a + i, reduce_avx512<L>(L::sub(vm, load_avx512(a + i)), vm));
+		return i;
+	}
+
+	// m above 2^(bits - 1): sums wrap around the word, so the reduction compares the operands instead
+	template <class L>
+	ALGEBRA_TARGET_AVX512 static size_t add_wide_avx512(typename L::scalar* a, const typename L::scalar* b, size_t n, uint64_t m)
+	{
+		const __m512i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+		{
+			// a + b >= m exactly when a >= m - b
+			__m512i x = load_avx512(a + i), y = load_avx512(b + i), complement = L::sub(vm, y);
+			store_avx512(a + i, L::select(L::ge(x, complement), L::sub(x, complement), L::add(x, y)));
+		}
+		return i;
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX512 static size_t sub_wide_avx512(typename L::scalar* a, const typename L::scalar* b, size_t n, uint64_t m)
+	{
+		const __m512i vm = L::set(m);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+		{
+			__m512i x = load_avx512(a + i), y = load_avx512(b + i), d = L::sub(x, y);
+			store_avx512(a + i, L::select(L::ge(x, y), d, L::add(d, vm)));
+		}
+		return i;
+	}
+
+	template <class L>
+	ALGEBRA_TARGET_AVX512 static size_t negate_wide_avx512(typename L::scalar* a, size_t n, uint64_t m)
+	{
+		const __m512i vm = L::set(m), one = L::set(1), zero = L::sub(vm, vm);
+		size_t i = 0;
+		for (; i + L::Count <= n; i += L::Count)
+		{
+			__m512i x = load_avx512(a + i);
+			store_avx512(a + i, L::select(L::ge(x, one), L::sub(vm, x), zero));
+		}
+		return i;
+	}
+
+	ALGEBRA_TARGET_AVX512 static __m512i scale16_avx512(__m512i x, __m512i c, __m512i shoup, __m512i m)
+	{
+		__m512i q = _mm512_mulhi_epu16(x, shoup);
+		__m512i r = _mm512_sub_epi16(_mm512_mullo_epi16(x, c), _mm512_mullo_epi16(q, m));
+		return reduce_avx512<Avx512Lanes16>(r, m);
+	}
+
+	ALGEBRA_TARGET_AVX512 static size_t scale_avx512(uint8_t* a, size_t n, uint64_t c, uint64_t m)
+	{
+		const __m512i vc = _mm512_set1_epi16(short(c)), vs = _mm512_set1_epi16(short((c << 16) / m)), vm = _mm512_set1_epi16(short(m));
+		size_t i = 0;
+		for (; i + 32 <= n; i += 32)
+		{
+			__m512i x = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i), _mm512_cvtepi16_epi8(scale16_avx512(x, vc, vs, vm)));
+		}
+		return i;
+	}
+
+	ALGEBRA_TARGET_AVX512 static size_t scale_avx512(uint16_t* a, size_t n, uint64_t c, uint64_t m)
+	{
+		const __m512i vc = _mm512_set1_epi16(short(c)), vs = _mm512_set1_epi16(short((c << 16) / m)), vm = _mm512_set1_epi16(short(m));
+		size_t i = 0;
+		for (; i + 32 <= n; i += 32)
+			store_avx512(a + i, scale16_avx512(load_avx512(a + i), vc, vs, vm));
+		return i;
+	}
+
+	ALGEBRA_TARGET_AVX512 static __m512i scale32_avx512(__m512i x, __m512i c, __m512i shoup, __m512i m)
+	{
+		__m512i even = _mm512_srli_epi64(_mm512_mul_epu32(x, shoup), 32);
+		__m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(x, 32), shoup);
+		__m512i q = _mm512_mask_blend_epi32(0xAAAA, even, odd);
+		__m512i r = _mm512_sub_epi32(_mm512_mullo_epi32(x, c), _mm512_mullo_epi32(q, m));
+		return reduce_avx512<Avx512Lanes32>(r, m);
+	}
+
+	ALGEBRA_TARGET_AVX512 static size_t scale_avx512(uint32_t* a, size_t n, uint64_t c, uint64_t m)
+	{
+		const __m512i vc = _mm512_set1_epi32(int(c)), vs = _mm512_set1_epi32(int((c << 32) / m)), vm = _mm512_set1_epi32(int(m));
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+			store_avx512(a + i, scale32_avx512(load_avx512(a + i), vc, vs, vm));
+		return i;
+	}
+
+	ALGEBRA_TARGET_AVX512 static __m512i widen16_avx512(const uint8_t* p)
+	{
+		return _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+	}
+
+	ALGEBRA_TARGET_AVX512 static __m512i widen16_avx512(const uint16_t* p)
+	{
+		return load_avx512(p);
+	}
+
+	template <class S>
+	ALGEBRA_TARGET_AVX512 static size_t has_root16_avx512(const S* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		const __m512i vm = _mm512_set1_epi16(short(m)), zero = _mm512_sub_epi32(vm, vm);
+		size_t j = 0;
+		for (; j + 32 <= n; j += 32)
+		{
+			__mmask32 found = 0;
+			for (uint64_t x = 0; x < m && found != 0xFFFFFFFFu; ++x)
+			{
+				const __m512i vx = _mm512_set1_epi16(short(x)), vs = _mm512_set1_epi16(short((x << 16) / m));
+				__m512i value = widen16_avx512(a + degree * stride + j);
+				for (size_t i = degree; i-- > 0;)
+					value = reduce_avx512<Avx512Lanes16>(_mm512_add_epi16(scale16_avx512(value, vx, vs, vm), widen16_avx512(a + i * stride + j)), vm);
+				found |= _mm512_cmpeq_epi16_mask(value, zero);
+			}
+			roots[j / 64] |= uint64_t(found) << (j % 64);
+		}
+		return j;
+	}
+
+	ALGEBRA_TARGET_AVX512 static size_t has_root32_avx512(const uint32_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		const __m512i vm = _mm512_set1_epi32(int(m)), zero = _mm512_sub_epi32(vm, vm);
+		size_t j = 0;
+		for (; j + 16 <= n; j += 16)
+		{
+			__mmask16 found = 0;
+			for (uint64_t x = 0; x < m && found != 0xFFFF; ++x)
+			{
+				const __m512i vx = _mm512_set1_epi32(int(x)), vs = _mm512_set1_epi32(int((x << 32) / m));
+				__m512i value = load_avx512(a + degree * stride + j);
+				for (size_t i = degree; i-- > 0;)
+					value = reduce_avx512<Avx512Lanes32>(_mm512_add_epi32(scale32_avx512(value, vx, vs, vm), load_avx512(a + i * stride + j)), vm);
+				found |= _mm512_cmpeq_epi32_mask(value, zero);
+			}
+			roots[j / 64] |= uint64_t(found) << (j % 64);
+		}
+		return j;
+	}
+
+	ALGEBRA_TARGET_AVX512 static size_t has_root_avx512(const uint8_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		return has_root16_avx512(a, stride, degree, n, m, roots);
+	}
+
+	ALGEBRA_TARGET_AVX512 static size_t has_root_avx512(const uint16_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		return has_root16_avx512(a, stride, degree, n, m, roots);
+	}
+
+	ALGEBRA_TARGET_AVX512 static size_t has_root_avx512(const uint32_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		return has_root32_avx512(a, stride, degree, n, m, roots);
+	}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+	static SIMD_LEVEL cpu_simd_level()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return SIMD_LEVEL::PORTABLE;
+		__cpuid(info, 1);
+		// the OS has to save the vector registers (OSXSAVE and XCR0)
+		if (!((info[2] >> 27) & 1) || !((info[2] >> 28) & 1))
+			return SIMD_LEVEL::PORTABLE;
+		unsigned long long xcr0 = _xgetbv(0);
+		__cpuidex(info, 7, 0);
+		if ((xcr0 & 0xE6) == 0xE6 && ((info[1] >> 16) & 1) && ((info[1] >> 30) & 1))
+			return SIMD_LEVEL::AVX512;
+		if ((xcr0 & 0x6) == 0x6 && ((info[1] >> 5) & 1))
+			return SIMD_LEVEL::AVX2;
+		return SIMD_LEVEL::PORTABLE;
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+			return SIMD_LEVEL::AVX512;
+		if (__builtin_cpu_supports("avx2"))
+			return SIMD_LEVEL::AVX2;
+		return SIMD_LEVEL::PORTABLE;
+#endif
+	}
+#else
+	static SIMD_LEVEL cpu_simd_level()
+	{
+		return SIMD_LEVEL::PORTABLE;
+	}
+#endif
+
+	/////////////// DISPATCH
+
+	// lane types of every width for one instruction set
+	template <class S> struct Lanes;
+#ifdef ALGEBRA_X86
+	template <> struct Lanes<uint8_t> { typedef Avx2Lanes8 Avx2; typedef Avx512Lanes8 Avx512; };
+	template <> struct Lanes<uint16_t> { typedef Avx2Lanes16 Avx2; typedef Avx512Lanes16 Avx512; };
+	template <> struct Lanes<uint32_t> { typedef Avx2Lanes32 Avx2; typedef Avx512Lanes32 Avx512; };
+#endif
+
+	static SIMD_LEVEL active_level()
+	{
+		SIMD_LEVEL level = CoefficientKernels::Supported();
+		if (CoefficientKernels::Level != SIMD_LEVEL::AUTO && CoefficientKernels::Level < level)
+			level = CoefficientKernels::Level;
+		return level;
+	}
+
+	// a lane holds 2m - 2 only when m <= 2^(bits - 1), wider moduli need the *_wide kernels
+	template <class S>
+	static bool fits(uint64_t m)
+	{
+		return m <= (uint64_t(1) << (8 * sizeof(S) - 1));
+	}
+
+	template <class S>
+	static void add(S* a, const S* b, size_t n, uint64_t m)
+	{
+		size_t done = 0;
+#ifdef ALGEBRA_X86
+		switch (active_level())
+		{
+		case SIMD_LEVEL::AVX512:
+			done = fits<S>(m) ? add_avx512<typename Lanes<S>::Avx512>(a, b, n, m) : add_wide_avx512<typename Lanes<S>::Avx512>(a, b, n, m);
+			break;
+		case SIMD_LEVEL::AVX2:
+			done = fits<S>(m) ? add_avx2<typename Lanes<S>::Avx2>(a, b, n, m) : add_wide_avx2<typename Lanes<S>::Avx2>(a, b, n, m);
+			break;
+		default:
+			break;
+		}
+#endif
+		add_portable(a + done, b + done, n - done, m);
+	}
+
+	template <class S>
+	static void sub(S* a, const S* b, size_t n, uint64_t m)
+	{
+		size_t done = 0;
+#ifdef ALGEBRA_X86
+		switch (active_level())
+		{
+		case SIMD_LEVEL::AVX512:
+			done = fits<S>(m) ? sub_avx512<typename Lanes<S>::Avx512>(a, b, n, m) : sub_wide_avx512<typename Lanes<S>::Avx512>(a, b, n, m);
+			break;
+		case SIMD_LEVEL::AVX2:
+			done = fits<S>(m) ? sub_avx2<typename Lanes<S>::Avx2>(a, b, n, m) : sub_wide_avx2<typename Lanes<S>::Avx2>(a, b, n, m);
+			break;
+		default:
+			break;
+		}
+#endif
+		sub_portable(a + done, b + done, n - done, m);
+	}
+
+	template <class S>
+	static void negate(S* a, size_t n, uint64_t m)
+	{
+		size_t done = 0;
+#ifdef ALGEBRA_X86
+		switch (active_level())
+		{
+		case SIMD_LEVEL::AVX512:
+			done = fits<S>(m) ? negate_avx512<typename Lanes<S>::Avx512>(a, n, m) : negate_wide_avx512<typename Lanes<S>::Avx512>(a, n, m);
+			break;
+		case SIMD_LEVEL::AVX2:
+			done = fits<S>(m) ? negate_avx2<typename Lanes<S>::Avx2>(a, n, m) : negate_wide_avx2<typename Lanes<S>::Avx2>(a, n, m);
+			break;
+		default:
+			break;
+		}
+#endif
+		negate_portable(a + done, n - done, m);
+	}
+
+	template <class S>
+	static void scale(S* a, size_t n, uint64_t c, uint64_t m)
+	{
+		size_t done = 0;
+#ifdef ALGEBRA_X86
+		// bytes are widened to 16-bit lanes, which hold 2m for any 8-bit m
+		switch (sizeof(S) == 1 || fits<S>(m) ? active_level() : SIMD_LEVEL::PORTABLE)
+		{
+		case SIMD_LEVEL::AVX512:
+			done = scale_avx512(a, n, c, m);
+			break;
+		case SIMD_LEVEL::AVX2:
+			done = scale_avx2(a, n, c, m);
+			break;
+		default:
+			break;
+		}
+#endif
+		scale_portable(a + done, n - done, c, m);
+	}
+
+	template <class S>
+	static void has_root(const S* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)
+	{
+		std::fill(roots, roots + (n + 63) / 64, uint64_t(0));
+		size_t done = 0;
+#ifdef ALGEBRA_X86
+		// the same lanes as scale: bytes are widened to 16 bits
+		switch (sizeof(S) == 1 || fits<S>(m) ? active_level() : SIMD_LEVEL::PORTABLE)
+		{
+		case SIMD_LEVEL::AVX512:
+			done = has_root_avx512(a, stride, degree, n, m, roots);
+			break;
+		case SIMD_LEVEL::AVX2:
+			done = has_root_avx2(a, stride, degree, n, m, roots);
+			break;
+		default:
+			break;
+		}
+#endif
+		has_root_portable(a, stride, degree, done, n, m, roots);
+	}
+
+	/////////////// IMPLEMENTATION
+
+	SIMD_LEVEL CoefficientKernels::Supported()
+	{
+		static const SIMD_LEVEL level = cpu_simd_level();
+		return level;
+	}
+
+	void CoefficientKernels::Add(uint8_t* a, const uint8_t* b, size_t n, uint64_t m)		{ add(a, b, n, m); }
+	void CoefficientKernels::Add(uint16_t* a, const uint16_t* b, size_t n, uint64_t m)		{ add(a, b, n, m); }
+	void CoefficientKernels::Add(uint32_t* a, const uint32_t* b, size_t n, uint64_t m)		{ add(a, b, n, m); }
+
+	void CoefficientKernels::Sub(uint8_t* a, const uint8_t* b, size_t n, uint64_t m)		{ sub(a, b, n, m); }
+	void CoefficientKernels::Sub(uint16_t* a, const uint16_t* b, size_t n, uint64_t m)		{ sub(a, b, n, m); }
+	void CoefficientKernels::Sub(uint32_t* a, const uint32_t* b, size_t n, uint64_t m)		{ sub(a, b, n, m); }
+
+	void CoefficientKernels::Negate(uint8_t* a, size_t n, uint64_t m)						{ negate(a, n, m); }
+	void CoefficientKernels::Negate(uint16_t* a, size_t n, uint64_t m)						{ negate(a, n, m); }
+	void CoefficientKernels::Negate(uint32_t* a, size_t n, uint64_t m)						{ negate(a, n, m); }
+
+	void CoefficientKernels::Scale(uint8_t* a, size_t n, uint64_t c, uint64_t m)			{ scale(a, n, c, m); }
+	void CoefficientKernels::Scale(uint16_t* a, size_t n, uint64_t c, uint64_t m)			{ scale(a, n, c, m); }
+	void CoefficientKernels::Scale(uint32_t* a, size_t n, uint64_t c, uint64_t m)			{ scale(a, n, c, m); }
+
+	void CoefficientKernels::HasRoot(const uint8_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)		{ has_root(a, stride, degree, n, m, roots); }
+	void CoefficientKernels::HasRoot(const uint16_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)	{ has_root(a, stride, degree, n, m, roots); }
+	void CoefficientKernels::HasRoot(const uint32_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots)	{ has_root(a, stride, degree, n, m, roots); }
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "ModInt.h"
+
+
+namespace Algebra
+{
+	enum class SIMD_LEVEL
+	{
+		AUTO,
+		PORTABLE,
+		AVX2,
+		AVX512
+	};
+
+	// Coefficient-wise arithmetic modulo m on residues (every value is below m) stored as 8, 16 or 32-bit words.
+	// A sum of two residues is below 2m, so one conditional subtraction (an unsigned min) reduces it, no division.
+	// AVX-512BW or AVX2 kernels are picked from CPUID, portable loops run otherwise
+	// and for m above 2^(bits - 1), whose sums do not fit into a word.
+	class CoefficientKernels
+	{
+	public:
+		// Caps the kernels at that level (it cannot go above what the CPU supports), AUTO takes the best one
+		static SIMD_LEVEL					Level;
+		// The level AUTO resolves to on this CPU
+		static SIMD_LEVEL		Supported	();
+
+		// a[i] = a[i] + b[i] mod m
+		static void				Add			(uint8_t* a, const uint8_t* b, size_t n, uint64_t m);
+		static void				Add			(uint16_t* a, const uint16_t* b, size_t n, uint64_t m);
+		static void				Add			(uint32_t* a, const uint32_t* b, size_t n, uint64_t m);
+		// a[i] = a[i] - b[i] mod m
+		static void				Sub			(uint8_t* a, const uint8_t* b, size_t n, uint64_t m);
+		static void				Sub			(uint16_t* a, const uint16_t* b, size_t n, uint64_t m);
+		static void				Sub			(uint32_t* a, const uint32_t* b, size_t n, uint64_t m);
+		// a[i] = -a[i] mod m
+		static void				Negate		(uint8_t* a, size_t n, uint64_t m);
+		static void				Negate		(uint16_t* a, size_t n, uint64_t m);
+		static void				Negate		(uint32_t* a, size_t n, uint64_t m);
+		// a[i] = a[i] * c mod m for c < m: Shoup's method with floor(c * 2^bits / m) computed once
+		static void				Scale		(uint8_t* a, size_t n, uint64_t c, uint64_t m);
+		static void				Scale		(uint16_t* a, size_t n, uint64_t c, uint64_t m);
+		static void				Scale		(uint32_t* a, size_t n, uint64_t c, uint64_t m);
+		// n polynomials of degree at most degree in structure-of-arrays layout, a[i * stride + j] is coefficient i of polynomial j:
+		// bit j % 64 of roots[j / 64] is set when polynomial j vanishes at some x < m, the other bits of the (n + 63) / 64 words are cleared.
+		// Horner's scheme at every x with one polynomial per lane, a block of lanes stops once all of them have a root
+		static void				HasRoot		(const uint8_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots);
+		static void				HasRoot		(const uint16_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots);
+		static void				HasRoot		(const uint32_t* a, size_t stride, size_t degree, size_t n, uint64_t m, uint64_t* roots);
+	};
+
+	// The same loops over ModInt<Zp> arrays: CoefficientKernels on the raw residues up to 32 bits,
+	// ModInt arithmetic for wider moduli
+	template <size_t Zp, bool Narrow = ModInt<Zp>::Narrow>
+	class CoefficientLoops
+	{
+		typedef ModInt<Zp> T;
+
+	public:
+		static void				Add			(T* a, const T* b, size_t n);
+		static void				Sub			(T* a, const T* b, size_t n);
+		static void				Negate		(T* a, size_t n);
+		static void				Scale		(T* a, size_t n, T c);
+		static void				HasRoot		(const T* a, size_t stride, size_t degree, size_t n, uint64_t* roots);
+	};
+
+	template <size_t Zp>
+	class CoefficientLoops<Zp, true>
+	{
+		typedef ModInt<Zp> T;
+		typedef typename T::storage_type S;
+		static_assert(sizeof(T) == sizeof(S) && std::is_standard_layout<T>::value, "ModInt has to be a bare residue");
+
+		static S*				raw			(T* a)			{ return reinterpret_cast<S*>(a); }
+		static const S*			raw			(const T* a)	{ return reinterpret_cast<const S*>(a); }
+
+	public:
+		static void				Add			(T* a, const T* b, size_t n)	{ CoefficientKernels::Add(raw(a), raw(b), n, Zp); }
+		static void				Sub			(T* a, const T* b, size_t n)	{ CoefficientKernels::Sub(raw(a), raw(b), n, Zp); }
+		static void				Negate		(T* a, size_t n)				{ CoefficientKernels::Negate(raw(a), n, Zp); }
+		static void				Scale		(T* a, size_t n, T c)			{ CoefficientKernels::Scale(raw(a), n, c.value(), Zp); }
+		static void				HasRoot		(const T* a, size_t stride, size_t degree, size_t n, uint64_t* roots)
+		{
+			CoefficientKernels::HasRoot(raw(a), stride, degree, n, Zp, roots);
+		}
+	};
+
+	/////////////// IMPLEMENTATION
+
+	template <size_t Zp, bool Narrow>
+	void CoefficientLoops<Zp, Narrow>::Add(T* a, const T* b, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			a[i] += b[i];
+	}
+
+	template <size_t Zp, bool Narrow>
+	void CoefficientLoops<Zp, Narrow>::Sub(T* a, const T* b, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			a[i] -= b[i];
+	}
+
+	template <size_t Zp, bool Narrow>
+	void CoefficientLoops<Zp, Narrow>::Negate(T* a, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			a[i] = -a[i];
+	}
+
+	template <size_t Zp, bool Narrow>
+	void CoefficientLoops<Zp, Narrow>::Scale(T* a, size_t n, T c)
+	{
+		for (size_t i = 0; i < n; ++i)
+			a[i] *= c;
+	}
+
+	template <size_t Zp, bool Narrow>
+	void CoefficientLoops<Zp, Narrow>::HasRoot(const T* a, size_t stride, size_t degree, size_t n, uint64_t* roots)
+	{
+		std::fill(roots, roots + (n + 63) / 64, uint64_t(0));
+		for (size_t j = 0; j < n; ++j)
+		{
+			bool root = false;
+			for (uint64_t x = 0; x < Zp && !root; ++x)
+			{
+				T value = a[degree * stride + j], point(x);
+				for (size_t i = degree; i-- > 0;)
+					value = value * point + a[i * stride + j];
+				root = !value;
+			}
+			if (root)
+				roots[j / 64] |= uint64_t(1) << (j % 64);
+		}
+	}
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include <limits>
+#include <stdexcept>
 #include "PolynomialGenerator.h"
 
 
@@ -19,6 +21,16 @@ namespace Algebra
 
 		virtual void reset() override;
 
+		// the next call returns At(k), k < Count()
+		void seek(size_t k);
+
+		// Zp^PolynomialDegree polynomials in the sequence, throws if it does not fit into size_t
+		static size_t Count();
+		// k-th polynomial of the sequence: x^PolynomialDegree plus the digits of k in base Zp as the lower coefficients
+		static Polynomial<Zp> At(size_t k);
+		// position of a monic polynomial of degree PolynomialDegree in the sequence
+		static size_t Index(const Polynomial<Zp>& p);
+
 		virtual ~ConsecutivePolynomialGenerator() = default;
 	};
 
@@ -30,7 +42,7 @@ namespace Algebra
 	Polynomial<Zp> ConsecutivePolynomialGenerator<Zp, PolynomialDegree>::operator()()
 	{
 		end_reached_ = false;
-		if (last_polynomial_.size() == 0)
+		if (last_polynomial_ == Polynomial<Zp>::Zero)
 		{
 			reset();
 			return last_polynomial_;
@@ -76,4 +88,41 @@ namespace Algebra
 		last_polynomial_ = std::vector<int>(PolynomialDegree + 1);
 		last_polynomial_.set(PolynomialDegree, 1);
 	}
+
+	template <size_t Zp, size_t PolynomialDegree>
+	void ConsecutivePolynomialGenerator<Zp, PolynomialDegree>::seek(size_t k)
+	{
+		end_reached_ = false;
+		// zero makes the next call start over from x^PolynomialDegree
+		last_polynomial_ = k ? At(k - 1) : Polynomial<Zp>::Zero;
+	}
+
+	template <size_t Zp, size_t PolynomialDegree>
+	size_t ConsecutivePolynomialGenerator<Zp, PolynomialDegree>::Count()
+	{
+		const size_t max = std::numeric_limits<size_t>::max();
+		size_t count = bounded_power(Zp, PolynomialDegree, max - 1);
+		if (count == max)
+			throw std::runtime_error("Number of polynomials does not fit into size_t");
+		return count;
+	}
+
+	template <size_t Zp, size_t PolynomialDegree>
+	Polynomial<Zp> ConsecutivePolynomialGenerator<Zp, PolynomialDegree>::At(size_t k)
+	{
+		Polynomial<Zp> res = Polynomial<Zp>::Zero;
+		res.set(PolynomialDegree, 1);
+		for (size_t i = 0; i < PolynomialDegree && k; ++i, k /= Zp)
+			res.set(i, static_cast<long long>(k % Zp));
+		return res;
+	}
+
+	template <size_t Zp, size_t PolynomialDegree>
+	size_t ConsecutivePolynomialGenerator<Zp, PolynomialDegree>::Index(const Polynomial<Zp>& p)
+	{
+		size_t k = 0;
+		for (size_t i = PolynomialDegree; i-- > 0;)
+			k = k * Zp + p[i];
+		return k;
+	}
 }
@@ -0,0 +1,144 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "Algebra.h"
+#include "Factorizer.h"
+
+
+namespace Algebra
+{
+	// Discrete logarithm in the cyclic group of a generator of known order n by Pohlig-Hellman:
+	// n is factored by Factorizer::Shared, the logarithm modulo every p^e is found digit by digit with baby-step giant-step
+	// over a hash table and the residues are joined by the Chinese Remainder Theorem. O(sum e * sqrt(p)) group operations.
+	// Group provides value_type (with std::hash), mul(a, b) and pow(a, k); it has to outlive the engine
+	template <class Group>
+	class DiscreteLogarithm
+	{
+		typedef typename Group::value_type T;
+
+		// the subgroup of order p^e: everything depending only on the generator is computed once
+		struct Subgroup
+		{
+			size_t prime, power, order;
+			// generator^(n / p^e) and its power of order p
+			T generator, gamma;
+			// gamma^-steps, a giant step
+			T giant;
+			size_t steps;
+			// gamma^j -> j for j < steps
+			std::unordered_map<T, size_t> baby;
+		};
+
+		const Group& group_;
+		T generator_;
+		size_t order_;
+		std::vector<Subgroup> subgroups_;
+
+		// d < p with gamma^d = y
+		bool			baby_giant		(const Subgroup& s, T y, size_t& d) const;
+
+	public:
+		// Baby steps kept per prime factor p: sqrt(p) unless it is larger, then the giant steps make up for it.
+		// Halving it halves the memory and doubles the giant steps
+		static size_t						MaxBabySteps;
+
+		// Factors order and fills the baby-step tables
+		DiscreteLogarithm				(const Group& group, const T& generator, size_t order);
+
+		size_t			order			()							const;
+		// x < order with generator^x = h, throws if h is not a power of the generator
+		size_t			operator()		(const T& h)				const;
+	};
+
+	/////////////// CONSTANT DEFINTION
+
+	template <class Group>
+	size_t DiscreteLogarithm<Group>::MaxBabySteps = size_t(1) << 20;
+
+	/////////////// IMPLEMENTATION
+
+	template <class Group>
+	DiscreteLogarithm<Group>::DiscreteLogarithm(const Group& group, const T& generator, size_t order) :
+		group_(group), generator_(generator), order_(order)
+	{
+		if (order == 0)
+			throw std::runtime_error("Group order cannot be zero");
+		for (const auto& factor : Factorizer::Shared(order))
+		{
+			// 1 = 1^0
+			if (factor.second == 0)
+				continue;
+			size_t prime = factor.first, power = factor.second, subgroup_order = 1;
+			for (size_t i = 0; i < power; ++i)
+				subgroup_order *= prime;
+			T subgroup_generator = group_.pow(generator_, order_ / subgroup_order);
+			T gamma = group_.pow(subgroup_generator, subgroup_order / prime);
+			size_t steps = std::max<size_t>(1, std::min(size_t(std::sqrt(double(prime))) + 1, MaxBabySteps));
+			Subgroup s = { prime, power, subgroup_order, subgroup_generator, gamma, group_.pow(gamma, prime - steps % prime), steps, {} };
+			s.baby.reserve(steps);
+			T x = group_.pow(gamma, 0);
+			for (size_t j = 0; j < steps; ++j)
+			{
+				s.baby.emplace(x, j);
+				x = group_.mul(x, gamma);
+			}
+			subgroups_.push_back(std::move(s));
+		}
+	}
+
+	template <class Group>
+	size_t DiscreteLogarithm<Group>::order() const
+	{
+		return order_;
+	}
+
+	template <class Group>
+	bool DiscreteLogarithm<Group>::baby_giant(const Subgroup& s, T y, size_t& d) const
+	{
+		// y * gamma^(-i * steps) = gamma^j gives d = i * steps + j
+		for (size_t i = 0, giants = (s.prime - 1) / s.steps + 1; i < giants; ++i)
+		{
+			auto it = s.baby.find(y);
+			if (it != s.baby.end())
+			{
+				d = i * s.steps + it->second;
+				return d < s.prime;
+			}
+			y = group_.mul(y, s.giant);
+		}
+		return false;
+	}
+
+	template <class Group>
+	size_t DiscreteLogarithm<Group>::operator()(const T& h) const
+	{
+		size_t x = 0, modulus = 1;
+		for (const auto& s : subgroups_)
+		{
+			// h^(n / p^e) = generator_s^xs, xs = d0 + d1 p + ... + d(e-1) p^(e-1)
+			T target = group_.pow(h, order_ / s.order);
+			size_t xs = 0, digit_weight = 1, rest = s.order / s.prime;
+			for (size_t k = 0; k < s.power; ++k)
+			{
+				// (generator_s^-xs * target)^(p^(e-1-k)) = gamma^dk
+				T y = group_.pow(group_.mul(group_.pow(s.generator, s.order - xs), target), rest);
+				size_t d;
+				if (!baby_giant(s, y, d))
+					throw std::runtime_error("Element is not a power of the generator");
+				xs += d * digit_weight;
+				digit_weight *= s.prime;
+				rest /= s.prime;
+			}
+			// x = x mod modulus and xs mod p^e
+			size_t t = mulmod((xs + s.order - x % s.order) % s.order, inverse_mod(modulus % s.order, s.order), s.order);
+			x += modulus * t;
+			modulus *= s.order;
+		}
+		if (!(group_.pow(generator_, x) == h))
+			throw std::runtime_error("Element is not a power of the generator");
+		return x;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <cstdint>
+
+
+namespace Algebra
+{
+	// Polynomial long division over a coefficient ring (ModularRing<Zp>, MontgomeryRing, ...).
+	// Leading coefficient of the divisor has to be invertible; the work is done in place, without allocations.
+	template <class Ring>
+	class Divider
+	{
+		typedef typename Ring::value_type T;
+
+		Ring ring_;
+
+	public:
+		explicit Divider				(const Ring& ring = Ring());
+
+		// Divides rem[0 .. nr) by div[0 .. nd), nr >= nd and div[nd - 1] is invertible.
+		// quot[0 .. nr - nd] gets the quotient (skipped when quot is null), rem[0 .. nd - 1) the remainder and rem[nd - 1 .. nr) is zeroed.
+		void			operator()		(T* rem, size_t nr, const T* div, size_t nd, T* quot) const;
+	};
+
+	/////////////// IMPLEMENTATION
+
+	template <class Ring>
+	Divider<Ring>::Divider(const Ring& ring) : ring_(ring)
+	{
+	}
+
+	template <class Ring>
+	void Divider<Ring>::operator()(T* rem, size_t nr, const T* div, size_t nd, T* quot) const
+	{
+		const T inverse = ring_.inverse(div[nd - 1]);
+		for (size_t k = nr - nd + 1; k-- > 0;)
+		{
+			T q = ring_.mul(rem[k + nd - 1], inverse);
+			if (quot)
+				quot[k] = q;
+			rem[k + nd - 1] = T();
+			if (q == T())
+				continue;
+			for (size_t j = 0; j + 1 < nd; ++j)
+				rem[k + j] = ring_.sub(rem[k + j], ring_.mul(q, div[j]));
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <cstdint>
+
+
+namespace Algebra
+{
+	// Window width for an exponent of that many bits: 2^(w-1) precomputed odd powers
+	// are paid back by one multiplication per w bits instead of one per set bit
+	inline unsigned window_width(uint64_t exponent)
+	{
+		unsigned bits = 0;
+		for (; exponent; exponent >>= 1)
+			++bits;
+		return bits > 48 ? 4 : bits > 16 ? 3 : bits > 6 ? 2 : 1;
+	}
+
+	// base^exponent in any monoid by left-to-right sliding window: one square() per bit
+	// and one multiply() per window of at most width bits ending with a set bit.
+	// multiply(a, b) and square(a) return the product, one is returned for exponent 0.
+	template <class T, class Multiply, class Square>
+	T window_power(const T& base, uint64_t exponent, const T& one, Multiply multiply, Square square, unsigned width)
+	{
+		if (exponent == 0)
+			return one;
+		// odd[i] = base^(2i + 1)
+		std::vector<T> odd(1, base);
+		if (width > 1)
+		{
+			T base2 = square(base);
+			for (size_t i = 1, sz = size_t(1) << (width - 1); i < sz; ++i)
+				odd.push_back(multiply(odd.back(), base2));
+		}
+
+		int bit = 63;
+		while (!((exponent >> bit) & 1))
+			--bit;
+		// the leading window starts the result instead of multiplying one
+		bool started = false;
+		T res = one;
+		while (bit >= 0)
+		{
+			if (!((exponent >> bit) & 1))
+			{
+				res = square(res);
+				--bit;
+				continue;
+			}
+			int low = bit + 1 > int(width) ? bit + 1 - int(width) : 0;
+			while (!((exponent >> low) & 1))
+				++low;
+			uint64_t window = (exponent >> low) & ((uint64_t(2) << (bit - low)) - 1);
+			if (started)
+			{
+				for (int i = low; i <= bit; ++i)
+					res = square(res);
+				res = multiply(res, odd[window >> 1]);
+			}
+			else
+				res = odd[window >> 1];
+			started = true;
+			bit = low - 1;
+		}
+		return res;
+	}
+
+	template <class T, class Multiply, class Square>
+	T window_power(const T& base, uint64_t exponent, const T& one, Multiply multiply, Square square)
+	{
+		return window_power(base, exponent, one, multiply, square, window_width(exponent));
+	}
+}
@@ -1,17 +1,77 @@
 #include "Factorizer.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include "Algebra.h"
+#include "ModInt.h"
 
 const std::vector<size_t> Algebra::Factorizer::CorePrimes = { 2 };
 
-bool Algebra::Factorizer::PrimeCheck_(size_t candidate)
+size_t Algebra::Factorizer::TrialDivisionLimit = size_t(1) << 16;
+
+size_t Algebra::Factorizer::SieveSegment = size_t(1) << 15;
+
+namespace
+{
+// the cache behind Factorizer::Shared
+std::shared_timed_mutex shared_lock;
+std::unordered_map<size_t, std::vector<std::pair<size_t, size_t>>> shared_factorizations;
+std::vector<size_t> shared_primes;
+
+// floor(sqrt(n)) without floating-point rounding errors
+size_t isqrt(size_t n)
+{
+	size_t root = std::min<size_t>(size_t(std::sqrt(double(n))), 0xFFFFFFFF);
+	while (root * root > n)
+		--root;
+	while (root < 0xFFFFFFFF && (root + 1) * (root + 1) <= n)
+		++root;
+	return root;
+}
+
+// Arithmetic modulo an odd number known at run time: Montgomery's form below 2^63, Algebra::mulmod above
+struct residue_ring
 {
-	size_t candidate_root = std::sqrtl(candidate) + 1;
-	size_t prime = 0;
-	for (size_t i = 0, sz = Primes.size(); i < sz && (prime = Primes[i]) <= candidate_root; ++i)
+	size_t modulus, factor, one;
+	bool montgomery;
+
+	explicit residue_ring(size_t n) :
+		modulus(n), factor(0 - Algebra::newton_inverse(n, n, 5)), montgomery(n < (size_t(1) << 63))
 	{
-		if (candidate % prime == 0)
-			return false;
+		// R = 2^64 mod n is the Montgomery form of 1
+		one = montgomery ? (0 - n) % n : 1 % n;
 	}
-	return true;
+
+	// a R mod n
+	size_t from(size_t a) const
+	{
+		return montgomery ? Algebra::mulmod(a % modulus, one, modulus) : a % modulus;
+	}
+
+	size_t mul(size_t a, size_t b) const
+	{
+		return montgomery ? Algebra::montgomery_reduce(Algebra::mulhi(a, b), a * b, modulus, factor) : Algebra::mulmod(a, b, modulus);
+	}
+
+	size_t add(size_t a, size_t b) const
+	{
+		return a >= modulus - b ? a - (modulus - b) : a + b;
+	}
+
+	size_t pow(size_t a, size_t e) const
+	{
+		size_t res = one;
+		for (; e; e >>= 1)
+		{
+			if (e & 1)
+				res = mul(res, a);
+			a = mul(a, a);
+		}
+		return res;
+	}
+};
 }
 
 std::vector<std::pair<size_t, size_t>> Algebra::Factorizer::operator()(size_t number)
@@ -24,27 +84,85 @@ std::vector<std::pair<size_t, size_t>> Algebra::Factorizer::operator()(size_t nu
 	std::vector<std::pair<size_t, size_t>> factorized;
 	if (!Primes.size())
 		FlushPrimes();
-	if (Primes[Primes.size() - 1] < number)
-		CalculatePrimesTo(number);
 
+	// sieve only as far as trial division can go: the square root, but not above the limit
 	auto numbc = number;
-	for (auto it = Primes.begin(), ed = Primes.end(); it != ed && numbc != 1; ++it)
+	CalculatePrimesTo(std::min(isqrt(number), TrialDivisionLimit));
+	for (size_t i = 0; i < Primes.size() && numbc != 1; ++i)
 	{
-		size_t degree = 0, prime = *it;
-		while (prime <= numbc && numbc % prime == 0)
+		size_t degree = 0, prime = Primes[i];
+		if (prime > numbc / prime)
+		{
+			// no divisor up to the square root
+			factorized.push_back(std::make_pair(numbc, size_t(1)));
+			numbc = 1;
+			break;
+		}
+		while (numbc % prime == 0)
 			++degree , numbc /= prime;
 		if (degree)
 			factorized.push_back(std::make_pair(prime, degree));
 	}
+	if (numbc == 1)
+		return factorized;
+
+	// every prime factor left is above the sieved primes: split by Pollard-Brent until Miller-Rabin accepts the parts
+	std::vector<size_t> large, parts(1, numbc);
+	while (!parts.empty())
+	{
+		size_t part = parts.back();
+		parts.pop_back();
+		if (IsPrime(part))
+		{
+			large.push_back(part);
+			continue;
+		}
+		size_t divisor = PollardBrent(part);
+		parts.push_back(divisor);
+		parts.push_back(part / divisor);
+	}
+	std::sort(large.begin(), large.end());
+	for (size_t prime : large)
+	{
+		if (!factorized.empty() && factorized.back().first == prime)
+			++factorized.back().second;
+		else
+			factorized.push_back(std::make_pair(prime, size_t(1)));
+	}
 	return factorized;
 }
 
 void Algebra::Factorizer::CalculatePrimesTo(size_t max_possible_prime)
 {
-	for (size_t sz = Primes.size(), curnumber = Primes[sz - 1] + 1; curnumber <= max_possible_prime; ++curnumber)
+	if (!Primes.size())
+		FlushPrimes();
+	if (max_possible_prime <= Primes.back())
+		return;
+	// crossing out needs the primes up to the square root of the bound
+	CalculatePrimesTo(isqrt(max_possible_prime));
+	const size_t base = Primes.size();
+	std::vector<char> composite;
+	for (size_t low = Primes.back() + 1; low <= max_possible_prime;)
 	{
-		if (PrimeCheck_(curnumber))
-			Primes.push_back(curnumber);
+		size_t high = max_possible_prime - low < SieveSegment ? max_possible_prime : low + SieveSegment - 1;
+		composite.assign(high - low + 1, 0);
+		for (size_t i = 0; i < base; ++i)
+		{
+			size_t prime = Primes[i];
+			if (prime > high / prime)
+				break;
+			size_t start = std::max(prime * prime, (low + prime - 1) / prime * prime);
+			for (size_t multiple = start; multiple <= high; multiple += prime)
+				composite[multiple - low] = 1;
+		}
+		for (size_t i = 0; i < composite.size(); ++i)
+		{
+			if (!composite[i])
+				Primes.push_back(low + i);
+		}
+		if (high == max_possible_prime)
+			break;
+		low = high + 1;
 	}
 }
 
@@ -52,3 +170,108 @@ void Algebra::Factorizer::FlushPrimes()
 {
 	Primes = CorePrimes;
 }
+
+bool Algebra::Factorizer::IsPrime(size_t number)
+{
+	static const size_t bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+	if (number < 2)
+		return false;
+	for (size_t prime : bases)
+	{
+		if (number % prime == 0)
+			return number == prime;
+	}
+	if (number < 41 * 41)
+		return true;
+	// number - 1 = d * 2^s with d odd
+	size_t d = number - 1, s = 0;
+	while (d % 2 == 0)
+		d /= 2, ++s;
+	residue_ring ring(number);
+	const size_t one = ring.one, minus_one = number - one;
+	for (size_t base : bases)
+	{
+		size_t x = ring.pow(ring.from(base), d);
+		if (x == one || x == minus_one)
+			continue;
+		bool witness = true;
+		for (size_t r = 1; r < s && witness; ++r)
+		{
+			x = ring.mul(x, x);
+			witness = x != minus_one;
+		}
+		if (witness)
+			return false;
+	}
+	return true;
+}
+
+size_t Algebra::Factorizer::PollardBrent(size_t number)
+{
+	if (number % 2 == 0)
+		return 2;
+	residue_ring ring(number);
+	// products of |x - y| taken before one gcd
+	const size_t batch = 128;
+	auto distance = [](size_t x, size_t y) { return x > y ? x - y : y - x; };
+	// x -> x^2 + c in Montgomery's form is x^2 / R + c, still a pseudo-random map and R is a unit
+	for (size_t c = 1;; ++c)
+	{
+		auto step = [&ring, c](size_t x) { return ring.add(ring.mul(x, x), c % ring.modulus); };
+		size_t y = ring.from(2), x = y, saved = y, product = ring.one, divisor = 1;
+		for (size_t length = 1; divisor == 1; length *= 2)
+		{
+			x = y;
+			for (size_t i = 0; i < length; ++i)
+				y = step(y);
+			for (size_t k = 0; k < length && divisor == 1; k += batch)
+			{
+				saved = y;
+				for (size_t i = 0; i < batch && i < length - k; ++i)
+				{
+					y = step(y);
+					product = ring.mul(product, distance(x, y));
+				}
+				divisor = gcd(product, number);
+			}
+		}
+		// the batch overshot, step through it again one gcd at a time
+		if (divisor == number)
+		{
+			do
+			{
+				saved = step(saved);
+				divisor = gcd(distance(x, saved), number);
+			}
+			while (divisor == 1);
+		}
+		if (divisor != number)
+			return divisor;
+	}
+}
+
+std::vector<std::pair<size_t, size_t>> Algebra::Factorizer::Shared(size_t number)
+{
+	Factorizer factorize;
+	{
+		std::shared_lock<std::shared_timed_mutex> guard(shared_lock);
+		auto it = shared_factorizations.find(number);
+		if (it != shared_factorizations.end())
+			return it->second;
+		factorize.Primes = shared_primes;
+	}
+	// two threads may factor the same number at once, both get the same result and the first one is kept
+	auto res = factorize(number);
+	std::unique_lock<std::shared_timed_mutex> guard(shared_lock);
+	if (factorize.Primes.size() > shared_primes.size())
+		shared_primes.swap(factorize.Primes);
+	shared_factorizations.emplace(number, res);
+	return res;
+}
+
+void Algebra::Factorizer::FlushShared()
+{
+	std::unique_lock<std::shared_timed_mutex> guard(shared_lock);
+	shared_factorizations.clear();
+	shared_primes.clear();
+}
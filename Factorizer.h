@@ -5,23 +5,39 @@
 
 namespace Algebra
 {
+	// Factors 64-bit numbers: trial division by sieved primes up to the square root of what is left,
+	// but not above TrialDivisionLimit. A cofactor left over is tested by Miller-Rabin and split by Pollard-Brent rho,
+	// so any number takes milliseconds
 	class Factorizer
 	{
 	protected:
 		std::vector<size_t> Primes;
 
-		bool PrimeCheck_(size_t candidate);
-
 	public:
 		static const std::vector<size_t> CorePrimes;
+		// Primes are sieved up to this bound at most, larger prime factors are found by PollardBrent
+		static size_t TrialDivisionLimit;
+		// Numbers sieved at once, a segment fits into the L1 cache
+		static size_t SieveSegment;
 
 		std::vector<std::pair<size_t, size_t>> operator()(size_t number);
 
+		// Segmented sieve of Eratosthenes from the last known prime on, the primes up to the square root come first
 		void CalculatePrimesTo(size_t max_possible_prime);
 
 		void FlushPrimes();;
 
-
+		// Deterministic Miller-Rabin: the first 12 primes as bases are enough for every 64-bit number
+		static bool IsPrime(size_t number);
+		// Nontrivial divisor of an odd composite number by Brent's cycle detection, gcds are taken over batches of products
+		static size_t PollardBrent(size_t number);
+
+		// Process-wide memoized operator(): a number is factored once, later calls from any thread copy the cached result.
+		// Lookups share a reader lock. A miss factors outside of the lock, starting from the shared prime table,
+		// then publishes the result and the grown table under the writer lock
+		static std::vector<std::pair<size_t, size_t>> Shared(size_t number);
+		// Drops the cached factorizations and the shared prime table
+		static void FlushShared();
 	};
 
 	inline std::ostream& operator << (std::ostream& s, const std::vector<std::pair<size_t, size_t>> &factorized) {
@@ -1,16 +1,42 @@
 #pragma once
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
 
 #include "PolynomialGenerator.h"
+#include "ConsecutivePolynomialGenerator.h"
+#include "WorkStealingScheduler.h"
 #include "Polynomial.h"
 #include "Factorizer.h"
+#include "DiscreteLogarithm.h"
+#include "PolynomialFactorizer.h"
+#include "PolynomialBatch.h"
 
 
 namespace Algebra
 {
+	enum class FIELD_REPRESENTATION
+	{
+		// every power of the generator as a polynomial
+		ELEMENTS,
+		// elements as integers with exp/log/Zech tables
+		TABLES,
+		// only the modulus and the generator, elements are computed on demand
+		LAZY
+	};
 
+	enum class IRREDUCIBLE_ENUMERATION
+	{
+		// TestIrreducibility on every monic candidate, spread over threads
+		GENERATE_AND_TEST,
+		// minimal polynomials of the cyclotomic coset representatives of a primitive element, nothing is tested
+		CYCLOTOMIC_COSETS
+	};
 
 	template<size_t Zp, size_t Deg>
 	// GF(Zp^Deg)
@@ -18,46 +44,119 @@ namespace Algebra
 	{
 
 		Polynomial<Zp> factor_;
+		// every product of elements is reduced against it
+		PolynomialModulus<Zp> modulus_;
 		Polynomial<Zp> generator_;
+		FIELD_REPRESENTATION representation_;
 		std::vector<Polynomial<Zp>> elements_ = { Polynomial<Zp>::One };
 
+		// compact fields: alpha^k, log_alpha of every code (the zero code maps to m_order())
+		// and Zech logarithms log_alpha(1 + alpha^k), m_order() where 1 + alpha^k = 0
+		typedef typename std::conditional<bounded_power(Zp, Deg, 1 << 16) <= (1 << 16), uint16_t, uint32_t>::type table_entry;
+		std::vector<table_entry> exp_, log_, zech_;
+
 		static_assert(Deg > 0, "Degree should be greater than zero to build non-trivial field");
+
+		bool compact() const;
+		bool lazy() const;
+		// codes of reduced polynomials
+		uint32_t code(const Polynomial<Zp>& reduced) const;
+		void build_tables();
+		static Polynomial<Zp> MinimalPolynomial(const PolynomialModulus<Zp>& modulus, const std::vector<Polynomial<Zp>>& conjugates);
+		// first monic polynomial of degree Deg in consecutive order with x primitive modulo it
+		static Polynomial<Zp> FindPrimitivePolynomial();
+		// shortest linear recurrence of s as a monic polynomial x^L + c1 x^(L-1) + ... + cL, O(|s|^2)
+		static Polynomial<Zp> BerlekampMassey(const std::vector<ModInt<Zp>>& s);
+		static std::vector<Polynomial<Zp>> EnumerateCyclotomicCosets();
+		// body(k, candidate) for the ConsecutivePolynomialGenerator candidates k in [begin, end) in order, until it returns false.
+		// Candidates with a root in GF(Zp) are left out, a PolynomialBatch of them screened at a time (see RootFilterLimit)
+		template <class Body>
+		static void ScreenCandidates(size_t begin, size_t end, Body body);
 	protected:
 
 
 
 		GaloisFieldExtension() = delete;
 
-		GaloisFieldExtension(const Polynomial<Zp>& factor, const Polynomial<Zp>& generator);
+		GaloisFieldExtension(const Polynomial<Zp>& factor, const Polynomial<Zp>& generator, FIELD_REPRESENTATION representation);
 
 		static GaloisFieldExtension BuildFactorGroup(const Polynomial<Zp>& factor);
 	public:
 		static Polynomial<Zp> DefaultGenerator;
-
-		// Most stupid test ever
+		// Representation of the fields built afterwards.
+		// TABLES (compact fields) encode elements as integers and keep exp/log/Zech tables instead of
+		// a polynomial per element: 16-bit entries up to 2^16 elements, 384 KB for GF(2^16). Needs a primitive generator.
+		// LAZY builds in O(M(deg)) for any order (GF(2^256) included), elements are residues mod factor
+		static FIELD_REPRESENTATION Representation;
+		// Largest Zp for which FindIrreducible and FindAllIrreducibles drop candidates with a root by evaluating them at every point,
+		// many candidates per SIMD pass, before running TestIrreducibility. Above it Ben-Or's first round finds the roots
+		static size_t RootFilterLimit;
+
+		// Element of a compact field: digit i in base Zp is the coefficient of x^i, 0 is zero
+		typedef uint32_t element;
+		// Residues mod factor taken by the arithmetic below, DiscreteLogarithm works on them
+		typedef Polynomial<Zp> value_type;
+
+		// Rabin's irreducibility test, x^(q^k) mod poly are computed in O(deg poly) memory against one PolynomialModulus
 		static bool RabinTest(const Polynomial<Zp>& poly);
+		// Ben-Or's irreducibility test: gcd(poly, x^(q^i) - x) = 1 for i up to deg / 2, stops at the first common factor.
+		// x^(q^(i+1)) = x^(q^i)(x^q) by Brent-Kung composition against a table of powers of x^q when that is cheaper than
+		// a q-th power, the table is only built once the first round has passed
+		static bool BenOrTest(const Polynomial<Zp>& poly);
 
-		// Field's order
+		// Field's order, throws if it does not fit into size_t
 		size_t order() const;
 
 		// Order of multiplicative gorup of the field
 		size_t m_order() const;
 
-		// get element by its order
+		// get element by its order: generator^order mod factor by PolynomialModulus::powmod in lazy fields
 		Polynomial<Zp> operator[](size_t order) const;
 
-		// find log_generator(poly mod factor)
+		// find log_generator(poly mod factor): a table lookup in compact fields, a scan over the elements with ELEMENTS,
+		// Pohlig-Hellman in lazy fields (the generator has to be primitive and the order has to fit into size_t).
+		// Use DiscreteLogarithm directly to keep its tables between calls
 		size_t log_alpha(const Polynomial<Zp>& poly) const;
 
+		// Residue arithmetic mod factor, works in every representation
+		Polynomial<Zp> add(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const;
+		Polynomial<Zp> sub(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const;
+		Polynomial<Zp> mul(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const;
+		// extended Euclid, throws for zero
+		Polynomial<Zp> inverse(const Polynomial<Zp>& a) const;
+		Polynomial<Zp> div(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const;
+		Polynomial<Zp> pow(const Polynomial<Zp>& a, size_t exponent) const;
+
+		// poly mod factor as element and back
+		element encode(const Polynomial<Zp>& poly) const;
+		Polynomial<Zp> decode(element e) const;
+
+		// TABLES fields only, O(1) table lookups.
+		// alpha^k and its inverse, throws for zero
+		element exp_alpha(size_t k) const;
+		size_t log_alpha(element e) const;
+		// alpha^i + alpha^j = alpha^(i + Z(j - i)) with the Zech logarithm Z(k) = log_alpha(1 + alpha^k)
+		element add(element a, element b) const;
+		element sub(element a, element b) const;
+		element negate(element a) const;
+		element mul(element a, element b) const;
+		// throws for zero divisor
+		element div(element a, element b) const;
+		element inverse(element a) const;
+
 		std::vector<size_t> GetAdjointElements(size_t elem_index) const;
 
+		// prod (X - b) over alpha^elem_index and its conjugates, computed in the field
 		Polynomial<Zp> FindMinimalPolynomial(size_t elem_index) const;
+		// The same for any residue mod modulus, conjugates are found by Frobenius steps (no element indexes)
+		static Polynomial<Zp> MinimalPolynomial(const PolynomialModulus<Zp>& modulus, const Polynomial<Zp>& root);
 
 		std::vector<size_t> FindAllPrimitiveElements(size_t order = powl(Zp, Deg)) const;
 
 		// Tests primitivity over finite field in subfield or field itself
 		static bool TestPrimitivity(size_t elem_order, size_t order = powl(Zp, Deg));
 
+		// Ben-Or's test, the first round finds the roots
 		static bool TestIrreducibility(const Polynomial<Zp>& poly);
 
 		static Polynomial<Zp> FindIrreducible(PolynomialGenerator<Zp, Deg> &generator)
@@ -86,12 +185,24 @@ namespace Algebra
 			throw std::runtime_error("Could not find an irreducible polynomial. Something wrong with Zp. Zp should be a prime number.");
 		}
 
-		// factorizes in field Zp^Deg
+		// factorizes over GF(Zp) into monic irreducibles by PolynomialFactorizer (see PolynomialFactorizer::Algorithm)
 		// first - irreducible polynomial, second - its arity
-		// Berlekamp's algorithm
 		std::vector<std::pair<Polynomial<Zp>, size_t>> FactorizeByFieldElements(const Polynomial<Zp>& poly) const;
 
 
+		// The first irreducible in consecutive order: the candidates are cut into chunks for a WorkStealingScheduler
+		// and a find cancels every chunk behind it. threads = 0 takes all cores
+		static Polynomial<Zp> FindIrreducible(size_t threads);
+
+		// Number of monic irreducibles of degree Deg by Gauss' formula: (1/Deg) sum over d | Deg of mu(d) Zp^(Deg/d)
+		static size_t CountIrreducibles();
+
+		// All monic irreducibles of degree Deg in consecutive order and CountIrreducibles() to check them against.
+		// GENERATE_AND_TEST runs on threads threads (0 - all cores) with the results merged chunk by chunk.
+		// CYCLOTOMIC_COSETS needs Zp^Deg - 1 < 2^32: it steps x^j mod a primitive polynomial once for every j,
+		// and the irreducible with roots alpha^(k Zp^i) is the recurrence of [x^0] x^(k j) found by Berlekamp-Massey
+		static std::pair<std::vector<Polynomial<Zp>>, size_t> FindAllIrreducibles(IRREDUCIBLE_ENUMERATION mode, size_t threads = 0);
+
 		static std::vector<Polynomial<Zp>> FindAllIrreducibles(PolynomialGenerator<Zp, Deg> &generator) noexcept(false)
 		{
 			std::vector<Polynomial<Zp>> res;
@@ -119,77 +230,326 @@ namespace Algebra
 	};
 
 	template<size_t Zp, size_t Deg>
-	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::DefaultGenerator = Polynomial<Zp>::X;
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::DefaultGenerator = { 0, 1 };
+
+	template<size_t Zp, size_t Deg>
+	FIELD_REPRESENTATION GaloisFieldExtension<Zp, Deg>::Representation = FIELD_REPRESENTATION::ELEMENTS;
+
+	template<size_t Zp, size_t Deg>
+	size_t GaloisFieldExtension<Zp, Deg>::RootFilterLimit = 4096;
 
 
 
 	// IMPLEMENTATION
 
 	template <size_t Zp, size_t Deg>
-	GaloisFieldExtension<Zp, Deg>::GaloisFieldExtension(const Polynomial<Zp>& factor, const Polynomial<Zp>& generator): factor_(factor), generator_(generator)
+	GaloisFieldExtension<Zp, Deg>::GaloisFieldExtension(const Polynomial<Zp>& factor, const Polynomial<Zp>& generator, FIELD_REPRESENTATION representation) :
+		factor_(factor), modulus_(factor), generator_(modulus_.reduce(generator)), representation_(representation)
 	{
+		if (representation_ != FIELD_REPRESENTATION::ELEMENTS)
+			elements_.clear();
 	}
 
 	template <size_t Zp, size_t Deg>
 	GaloisFieldExtension<Zp, Deg> GaloisFieldExtension<Zp, Deg>::BuildFactorGroup(const Polynomial<Zp>& factor)
 	{
 		auto generator = GaloisFieldExtension::DefaultGenerator;
-		GaloisFieldExtension f(factor, generator);
+		GaloisFieldExtension f(factor, generator, Representation);
+		if (f.lazy())
+			return f;
+		if (f.compact())
+		{
+			f.build_tables();
+			return f;
+		}
 		size_t i = 0;
-		auto poly = Polynomial<Zp>::One;
-		do
+		// q - 1 powers at most, fewer when the generator is not primitive: the reserve is capped, growth takes over above it
+		const size_t limit = size_t(1) << 16;
+		f.elements_.reserve(std::min(bounded_power(Zp, factor.deg(), limit), limit) - 1);
+		while (true)
 		{
-			poly = (generator * f.elements_[i++]) % f.factor_;
-			if (poly.deg() != 0)
-				f.elements_.push_back(poly);
+			auto poly = f.modulus_.mulmod(generator, f.elements_[i++]);
+			// constants other than 1 are powers of alpha too when Zp > 2
+			if (poly == Polynomial<Zp>::One || poly == Polynomial<Zp>::Zero)
+				break;
+			f.elements_.push_back(std::move(poly));
 		}
-		while (poly.deg() != 0);
 		return f;
 	}
 
+	template <size_t Zp, size_t Deg>
+	bool GaloisFieldExtension<Zp, Deg>::compact() const
+	{
+		return representation_ == FIELD_REPRESENTATION::TABLES;
+	}
+
+	template <size_t Zp, size_t Deg>
+	bool GaloisFieldExtension<Zp, Deg>::lazy() const
+	{
+		return representation_ == FIELD_REPRESENTATION::LAZY;
+	}
+
+	template <size_t Zp, size_t Deg>
+	uint32_t GaloisFieldExtension<Zp, Deg>::code(const Polynomial<Zp>& reduced) const
+	{
+		uint64_t res = 0;
+		for (size_t i = reduced.deg(); i != size_t(-1); --i)
+			res = res * Zp + reduced[i];
+		return uint32_t(res);
+	}
+
+	template <size_t Zp, size_t Deg>
+	void GaloisFieldExtension<Zp, Deg>::build_tables()
+	{
+		// codes and logarithms are below q
+		const size_t limit = size_t(std::numeric_limits<table_entry>::max()) + 1;
+		size_t q = bounded_power(Zp, factor_.deg(), limit);
+		if (q > limit)
+			throw std::runtime_error("The field is too large for element tables");
+		const size_t m = q - 1;
+		exp_.reserve(m);
+		log_.assign(q, table_entry(m));
+		auto power = Polynomial<Zp>::One;
+		do
+		{
+			uint32_t c = code(power);
+			log_[c] = table_entry(exp_.size());
+			exp_.push_back(table_entry(c));
+			power = modulus_.mulmod(generator_, power);
+		} while (power != Polynomial<Zp>::One && exp_.size() < m);
+		if (exp_.size() != m || power != Polynomial<Zp>::One)
+			throw std::runtime_error("Element tables need a primitive generator");
+		// 1 + c only changes the lowest digit
+		zech_.resize(m);
+		for (size_t k = 0; k < m; ++k)
+		{
+			uint32_t c = exp_[k], sum = c % Zp == Zp - 1 ? c - uint32_t(Zp - 1) : c + 1;
+			zech_[k] = sum ? log_[sum] : table_entry(m);
+		}
+	}
+
 	template <size_t Zp, size_t Deg>
 	bool GaloisFieldExtension<Zp, Deg>::RabinTest(const Polynomial<Zp>& poly)
 	{
 		auto deg = poly.deg();
-		Factorizer factorize;
-		auto divisors = factorize(deg);
+		// same answer as BenOrTest, the factorization below needs deg > 1
+		if (deg <= 1)
+			return true;
+		auto divisors = Factorizer::Shared(deg);
+		// x^(q^k) - x mod poly, one precomputed modulus for every k
+		PolynomialModulus<Zp> modulus(poly);
+		auto special = [&modulus](size_t k) { return modulus.reduce(modulus.frobenius(Polynomial<Zp>::X, k) - Polynomial<Zp>::X); };
 		for (const auto& divisor : divisors)
 		{
+			// {1, 0} and {0, 0} are sentinels, not prime divisors
+			if (!divisor.second)
+				continue;
 			auto nj = deg / divisor.first;
-			if (Polynomial<Zp>::Gcd(poly, Polynomial<Zp>::SpecialPolyMod(nj, poly)) != Polynomial<Zp>::One)
+			// gcd is defined up to a constant factor
+			if (Polynomial<Zp>::Gcd(poly, special(nj)).deg() != 0)
 				return false;
 		}
-		return Polynomial<Zp>::SpecialPolyMod(deg, poly) == Polynomial<Zp>::Zero;
+		return special(deg) == Polynomial<Zp>::Zero;
+	}
+
+	template <size_t Zp, size_t Deg>
+	bool GaloisFieldExtension<Zp, Deg>::BenOrTest(const Polynomial<Zp>& poly)
+	{
+		const size_t deg = poly.deg();
+		if (deg <= 1)
+			return true;
+		PolynomialModulus<Zp> modulus(poly);
+		const Polynomial<Zp> x = modulus.reduce(Polynomial<Zp>::X), xq = modulus.frobenius(x, 1);
+		// a q-th power costs about log2(q) products, a composition about deg / m of them
+		const size_t block = composition_block(deg);
+		size_t bits = 0;
+		for (size_t q = Zp; q; q >>= 1)
+			++bits;
+		const bool compose = !Polynomial<Zp>::SpreadPowers && bits > block;
+		std::vector<Polynomial<Zp>> table;
+		Polynomial<Zp> h = xq;
+		for (size_t i = 1; 2 * i <= deg; ++i)
+		{
+			// most reducible candidates have a small factor and leave here in the first rounds
+			if (Polynomial<Zp>::Gcd(poly, h - x).deg() != 0)
+				return false;
+			if (2 * (i + 1) > deg)
+				break;
+			if (!compose)
+				h = modulus.frobenius(h, 1);
+			else
+			{
+				if (table.empty())
+					table = modulus.power_table(xq, block);
+				h = modulus.compose(h, table);
+			}
+		}
+		return true;
 	}
 
 	template <size_t Zp, size_t Deg>
 	size_t GaloisFieldExtension<Zp, Deg>::order() const
 	{
-		return elements_.size() + 1;
+		if (!lazy())
+			return m_order() + 1;
+		const size_t max = std::numeric_limits<size_t>::max();
+		// Zp^n is never 2^64 - 1, that value flags an overflow
+		size_t q = bounded_power(Zp, factor_.deg(), max - 1);
+		if (q == max)
+			throw std::runtime_error("Field order does not fit into size_t");
+		return q;
 	}
 
 	template <size_t Zp, size_t Deg>
 	size_t GaloisFieldExtension<Zp, Deg>::m_order() const
 	{
-		return elements_.size();
+		return lazy() ? order() - 1 : compact() ? exp_.size() : elements_.size();
 	}
 
 	template <size_t Zp, size_t Deg>
 	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::operator[](size_t order) const
 	{
-		return elements_[order];
+		if (lazy())
+			return modulus_.powmod(generator_, order);
+		return compact() ? decode(exp_[order]) : elements_[order];
 	}
 
 	template <size_t Zp, size_t Deg>
 	size_t GaloisFieldExtension<Zp, Deg>::log_alpha(const Polynomial<Zp>& poly) const
 	{
-		auto remainder = poly % factor_;
+		auto remainder = modulus_.reduce(poly);
+		if (compact())
+			return log_alpha(code(remainder));
+		if (lazy())
+			return DiscreteLogarithm<GaloisFieldExtension>(*this, generator_, m_order())(remainder);
 		for (size_t i = 0, sz = elements_.size(); i < sz; ++i)
 			if (remainder == elements_[i])
 				return i;
 		throw std::runtime_error("Could not find logarithm of alpha. This is strange.");
 	}
 
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::add(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const
+	{
+		return modulus_.reduce(a + b);
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::sub(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const
+	{
+		return modulus_.reduce(a - b);
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::mul(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const
+	{
+		return modulus_.mulmod(a, b);
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::inverse(const Polynomial<Zp>& a) const
+	{
+		if (modulus_.reduce(a) == Polynomial<Zp>::Zero)
+			throw std::runtime_error("Cannot divide by zero");
+		return Polynomial<Zp>::ExpandedGcd(a, Polynomial<Zp>::One, factor_);
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::div(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const
+	{
+		return modulus_.mulmod(a, inverse(b));
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::pow(const Polynomial<Zp>& a, size_t exponent) const
+	{
+		return modulus_.powmod(a, exponent);
+	}
+
+	template <size_t Zp, size_t Deg>
+	typename GaloisFieldExtension<Zp, Deg>::element GaloisFieldExtension<Zp, Deg>::encode(const Polynomial<Zp>& poly) const
+	{
+		return code(modulus_.reduce(poly));
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::decode(element e) const
+	{
+		std::vector<int> digits;
+		for (; e; e /= Zp)
+			digits.push_back(int(e % Zp));
+		return digits.empty() ? Polynomial<Zp>::Zero : Polynomial<Zp>(digits);
+	}
+
+	template <size_t Zp, size_t Deg>
+	typename GaloisFieldExtension<Zp, Deg>::element GaloisFieldExtension<Zp, Deg>::exp_alpha(size_t k) const
+	{
+		return exp_[k % exp_.size()];
+	}
+
+	template <size_t Zp, size_t Deg>
+	size_t GaloisFieldExtension<Zp, Deg>::log_alpha(element e) const
+	{
+		if (!e)
+			throw std::runtime_error("Zero has no logarithm");
+		return log_[e];
+	}
+
+	template <size_t Zp, size_t Deg>
+	typename GaloisFieldExtension<Zp, Deg>::element GaloisFieldExtension<Zp, Deg>::add(element a, element b) const
+	{
+		if (!a || !b)
+			return a | b;
+		const size_t m = exp_.size(), la = log_[a], lb = log_[b];
+		size_t z = zech_[lb >= la ? lb - la : lb + m - la];
+		if (z == m)
+			return 0;
+		z += la;
+		return exp_[z >= m ? z - m : z];
+	}
+
+	template <size_t Zp, size_t Deg>
+	typename GaloisFieldExtension<Zp, Deg>::element GaloisFieldExtension<Zp, Deg>::sub(element a, element b) const
+	{
+		return add(a, negate(b));
+	}
+
+	template <size_t Zp, size_t Deg>
+	typename GaloisFieldExtension<Zp, Deg>::element GaloisFieldExtension<Zp, Deg>::negate(element a) const
+	{
+		// -1 = alpha^(m / 2) in odd characteristic
+		if (!a || Zp == 2)
+			return a;
+		const size_t m = exp_.size(), l = log_[a] + m / 2;
+		return exp_[l >= m ? l - m : l];
+	}
+
+	template <size_t Zp, size_t Deg>
+	typename GaloisFieldExtension<Zp, Deg>::element GaloisFieldExtension<Zp, Deg>::mul(element a, element b) const
+	{
+		if (!a || !b)
+			return 0;
+		const size_t m = exp_.size(), l = size_t(log_[a]) + log_[b];
+		return exp_[l >= m ? l - m : l];
+	}
+
+	template <size_t Zp, size_t Deg>
+	typename GaloisFieldExtension<Zp, Deg>::element GaloisFieldExtension<Zp, Deg>::div(element a, element b) const
+	{
+		if (!b)
+			throw std::runtime_error("Cannot divide by zero");
+		if (!a)
+			return 0;
+		const size_t m = exp_.size(), la = log_[a], lb = log_[b];
+		return exp_[la >= lb ? la - lb : la + m - lb];
+	}
+
+	template <size_t Zp, size_t Deg>
+	typename GaloisFieldExtension<Zp, Deg>::element GaloisFieldExtension<Zp, Deg>::inverse(element a) const
+	{
+		return div(1, a);
+	}
+
 	template <size_t Zp, size_t Deg>
 	std::vector<size_t> GaloisFieldExtension<Zp, Deg>::GetAdjointElements(size_t elem_index) const
 	{
@@ -210,13 +570,58 @@ namespace Algebra
 	template <size_t Zp, size_t Deg>
 	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::FindMinimalPolynomial(size_t elem_index) const
 	{
-		auto adjoints = GetAdjointElements(elem_index);
-		auto poly = Polynomial<Zp>::X - elements_[elem_index];
-		for (auto adjoint : adjoints)
+		if (lazy())
+			return MinimalPolynomial(modulus_, modulus_.powmod(generator_, elem_index));
+		auto roots = GetAdjointElements(elem_index);
+		roots.insert(roots.begin(), elem_index);
+		if (!compact())
+		{
+			std::vector<Polynomial<Zp>> conjugates;
+			for (auto root : roots)
+				conjugates.push_back(elements_[root]);
+			return MinimalPolynomial(modulus_, conjugates);
+		}
+		// the same product as in MinimalPolynomial by table lookups
+		std::vector<element> c(1, 1);
+		for (auto root : roots)
+		{
+			element r = exp_[root], top = c.back();
+			c.push_back(top);
+			for (size_t i = c.size() - 2; i > 0; --i)
+				c[i] = sub(c[i - 1], mul(r, c[i]));
+			c[0] = negate(mul(r, c[0]));
+		}
+		return Polynomial<Zp>(std::vector<int>(c.begin(), c.end()));
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::MinimalPolynomial(const PolynomialModulus<Zp>& modulus, const Polynomial<Zp>& root)
+	{
+		// r, r^Zp, r^(Zp^2), ... until it comes back to r
+		std::vector<Polynomial<Zp>> conjugates(1, modulus.reduce(root));
+		for (auto next = modulus.frobenius(conjugates[0], 1); next != conjugates[0] && conjugates.size() < modulus.deg(); next = modulus.frobenius(next, 1))
+			conjugates.push_back(next);
+		return MinimalPolynomial(modulus, conjugates);
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::MinimalPolynomial(const PolynomialModulus<Zp>& modulus, const std::vector<Polynomial<Zp>>& conjugates)
+	{
+		// coefficients of the product are field elements, c[i] <- c[i - 1] - root * c[i] for every root;
+		// they all end up in GF(Zp)
+		std::vector<Polynomial<Zp>> c(1, Polynomial<Zp>::One);
+		for (const auto& r : conjugates)
 		{
-			poly *= Polynomial<Zp>::X - elements_[adjoint];
+			c.emplace_back(Polynomial<Zp>::Zero);
+			c.back() = c[c.size() - 2];
+			for (size_t i = c.size() - 2; i > 0; --i)
+				c[i] = c[i - 1] - modulus.mulmod(r, c[i]);
+			c[0] = modulus.mulmod(r, c[0]).negate();
 		}
-		return poly;
+		std::vector<int> res(c.size());
+		for (size_t i = 0; i < c.size(); ++i)
+			res[i] = int(c[i][0]);
+		return Polynomial<Zp>(res);
 	}
 
 	template <size_t Zp, size_t Deg>
@@ -246,9 +651,8 @@ namespace Algebra
 	template <size_t Zp, size_t Deg>
 	bool GaloisFieldExtension<Zp, Deg>::TestPrimitivity(size_t elem_order, size_t order)
 	{
-		Factorizer frizer;
 		auto mult_order = order - 1;
-		auto factors = frizer(mult_order);
+		auto factors = Factorizer::Shared(mult_order);
 		for (auto factor : factors)
 		{
 			size_t p_i = mult_order / factor.first;
@@ -261,64 +665,286 @@ namespace Algebra
 	template <size_t Zp, size_t Deg>
 	bool GaloisFieldExtension<Zp, Deg>::TestIrreducibility(const Polynomial<Zp>& poly)
 	{
-		auto deg = poly.deg();
-		if (deg <= 1)
-			return true;
-		for (size_t x = 0; x < Zp; ++x)
-			if (!poly.eval(x))
+		return BenOrTest(poly);
+	}
+
+	template <size_t Zp, size_t Deg>
+	template <class Body>
+	void GaloisFieldExtension<Zp, Deg>::ScreenCandidates(size_t begin, size_t end, Body body)
+	{
+		ConsecutivePolynomialGenerator<Zp, Deg> candidates;
+		candidates.seek(begin);
+		// every polynomial of degree 1 has a root and is irreducible
+		if (Deg == 1 || Zp > RootFilterLimit)
+		{
+			for (size_t k = begin; k < end && body(k, candidates()); ++k)
+				;
+			return;
+		}
+		// one word of the root mask per batch
+		PolynomialBatch<Zp> batch(Deg, 64);
+		std::vector<Polynomial<Zp>> polys;
+		polys.reserve(batch.capacity());
+		for (size_t first = begin; first < end; first += batch.capacity())
+		{
+			batch.clear();
+			polys.clear();
+			for (size_t k = first; k < end && polys.size() < batch.capacity(); ++k)
+			{
+				polys.push_back(candidates());
+				batch.push_back(polys.back());
+			}
+			uint64_t roots = batch.roots()[0];
+			for (size_t j = 0; j < polys.size(); ++j)
+			{
+				if (!(roots >> j & 1) && !body(first + j, polys[j]))
+					return;
+			}
+		}
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::FindIrreducible(size_t threads)
+	{
+		typedef ConsecutivePolynomialGenerator<Zp, Deg> generator;
+		const size_t count = generator::Count();
+		WorkStealingScheduler scheduler(count, threads);
+		scheduler.run([&scheduler](size_t begin, size_t end)
+		{
+			ScreenCandidates(begin, end, [&scheduler](size_t k, const Polynomial<Zp>& candidate)
+			{
+				// the limit drops when some other worker finds an irreducible in front of this chunk
+				if (k >= scheduler.limit())
+					return false;
+				if (!TestIrreducibility(candidate))
+					return true;
+				scheduler.cancel_from(k);
 				return false;
-		if (deg <= 3)
-			return true;
-		else
+			});
+		});
+		if (scheduler.limit() == count)
+			throw std::runtime_error("Could not find an irreducible polynomial. Something wrong with Zp. Zp should be a prime number.");
+		return generator::At(scheduler.limit());
+	}
+
+	template <size_t Zp, size_t Deg>
+	size_t GaloisFieldExtension<Zp, Deg>::CountIrreducibles()
+	{
+		// throws if Zp^Deg does not fit, smaller powers do then
+		ConsecutivePolynomialGenerator<Zp, Deg>::Count();
+		std::vector<size_t> primes;
+		for (const auto& factor : Factorizer::Shared(Deg))
 		{
-			return RabinTest(poly);
+			if (factor.second)
+				primes.push_back(factor.first);
+		}
+		// mu(d) is (-1)^k for d a product of k distinct primes and 0 otherwise
+		size_t plus = 0, minus = 0;
+		for (size_t subset = 0; subset < (size_t(1) << primes.size()); ++subset)
+		{
+			size_t d = 1, k = 0;
+			for (size_t i = 0; i < primes.size(); ++i)
+			{
+				if (subset >> i & 1)
+					d *= primes[i], ++k;
+			}
+			(k % 2 ? minus : plus) += bounded_power(Zp, Deg / d, std::numeric_limits<size_t>::max());
 		}
+		return (plus - minus) / Deg;
+	}
 
-		return true;
+	template <size_t Zp, size_t Deg>
+	std::pair<std::vector<Polynomial<Zp>>, size_t> GaloisFieldExtension<Zp, Deg>::FindAllIrreducibles(IRREDUCIBLE_ENUMERATION mode, size_t threads)
+	{
+		typedef ConsecutivePolynomialGenerator<Zp, Deg> generator;
+		const size_t predicted = CountIrreducibles();
+		if (mode == IRREDUCIBLE_ENUMERATION::CYCLOTOMIC_COSETS)
+			return std::make_pair(EnumerateCyclotomicCosets(), predicted);
+
+		const size_t count = generator::Count(), chunk = WorkStealingScheduler::DefaultChunk;
+		// every chunk has its own slot, joining the slots in order gives the serial order whatever ran where
+		std::vector<std::vector<Polynomial<Zp>>> found((count + chunk - 1) / chunk);
+		WorkStealingScheduler scheduler(count, threads, chunk);
+		scheduler.run([&found, chunk](size_t begin, size_t end)
+		{
+			auto& out = found[begin / chunk];
+			ScreenCandidates(begin, end, [&out](size_t, const Polynomial<Zp>& candidate)
+			{
+				if (TestIrreducibility(candidate))
+					out.push_back(candidate);
+				return true;
+			});
+		});
+		std::vector<Polynomial<Zp>> res;
+		res.reserve(predicted);
+		for (auto& part : found)
+			std::move(part.begin(), part.end(), std::back_inserter(res));
+		return std::make_pair(std::move(res), predicted);
 	}
 
 	template <size_t Zp, size_t Deg>
-	std::vector<std::pair<Polynomial<Zp>, size_t>> GaloisFieldExtension<Zp, Deg>::FactorizeByFieldElements(const Polynomial<Zp>& poly) const
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::FindPrimitivePolynomial()
 	{
-		std::vector<std::pair<Polynomial<Zp>, size_t>> factors;
-		// check simple roots
-		// TODO: Make it real Berlekamp's algorithm instead of this fucking dumb cycle
-		auto cur_poly = poly;
-		size_t cdeg = cur_poly.deg();
-		for (size_t i = 0, sz = order(); i < sz; ++i)
+		typedef ConsecutivePolynomialGenerator<Zp, Deg> generator;
+		const size_t count = generator::Count(), m = count - 1;
+		auto factors = Factorizer::Shared(m);
+		for (size_t k = 0; k < count; ++k)
 		{
-			auto elem = i ? elements_[i - 1] : Polynomial<Zp>::Zero;
-			if (cdeg >= elem.deg() && elem != Polynomial<Zp>::X)
+			Polynomial<Zp> candidate = generator::At(k);
+			// x divides candidates with f(0) = 0, it cannot be a unit there
+			if (candidate[0] == 0 || !TestIrreducibility(candidate))
+				continue;
+			// x^(m / p) != 1 for every prime p | m
+			PolynomialModulus<Zp> modulus(candidate);
+			bool primitive = true;
+			for (const auto& factor : factors)
 			{
-				auto root = Polynomial<Zp>::X - elem;
-				if (root != Polynomial<Zp>::One)
+				if (factor.second && modulus.powmod(Polynomial<Zp>::X, m / factor.first) == Polynomial<Zp>::One)
 				{
-					auto div_res = cur_poly.divide(root);
-					size_t arity = 0;
-					while (div_res.second == Polynomial<Zp>::Zero)
-					{
-						++arity;
-						cur_poly = div_res.first;
-						cdeg = cur_poly.deg();
-						div_res = cur_poly.divide(root);
-					}
-					if (arity != 0)
-						factors.push_back(std::make_pair(root, arity));
+					primitive = false;
+					break;
 				}
 			}
-			// factorized successfully
-			if (cdeg == 0)
-				break;
+			if (primitive)
+				return candidate;
+		}
+		throw std::runtime_error("Could not find a primitive polynomial. Zp should be a prime number.");
+	}
+
+	template <size_t Zp, size_t Deg>
+	Polynomial<Zp> GaloisFieldExtension<Zp, Deg>::BerlekampMassey(const std::vector<ModInt<Zp>>& s)
+	{
+		typedef ModInt<Zp> coefficient;
+		// c is the connection polynomial (c[0] = 1) of the shortest recurrence so far, deg c <= length;
+		// b is the one before the last length change, scaled by the inverse of its discrepancy
+		const size_t n = s.size();
+		std::vector<coefficient> c(n + 1), b(n + 1), previous(n + 1);
+		c[0] = b[0] = coefficient(1);
+		coefficient last_inverse(1);
+		size_t length = 0, b_length = 1, shift = 1;
+		for (size_t i = 0; i < n; ++i)
+		{
+			coefficient d = s[i];
+			for (size_t j = 1; j <= length; ++j)
+				d += c[j] * s[i - j];
+			if (!d)
+			{
+				++shift;
+				continue;
+			}
+			bool grow = 2 * length <= i;
+			if (grow)
+				std::copy(c.begin(), c.begin() + length + 1, previous.begin());
+			coefficient factor = d * last_inverse;
+			for (size_t j = 0; j < b_length && j + shift <= n; ++j)
+				c[j + shift] -= factor * b[j];
+			if (grow)
+			{
+				b_length = length + 1;
+				length = i + 1 - length;
+				b.swap(previous);
+				last_inverse = d.inverse();
+				shift = 1;
+			}
+			else
+				++shift;
 		}
-		if (cdeg != 0)
-			factors.push_back(std::make_pair(cur_poly, 1));
-		return factors;
+		// x^length c(1 / x)
+		Polynomial<Zp> res = Polynomial<Zp>::Zero;
+		for (size_t j = 0; j <= length; ++j)
+			res.set(length - j, static_cast<long long>(c[j].value()));
+		return res;
+	}
+
+	template <size_t Zp, size_t Deg>
+	std::vector<Polynomial<Zp>> GaloisFieldExtension<Zp, Deg>::EnumerateCyclotomicCosets()
+	{
+		typedef ConsecutivePolynomialGenerator<Zp, Deg> generator;
+		const size_t m = generator::Count() - 1;
+		if (m > std::numeric_limits<uint32_t>::max())
+			throw std::runtime_error("Too many field elements to enumerate cyclotomic cosets");
+		const Polynomial<Zp> f = FindPrimitivePolynomial();
+
+		// u[j] = [x^0] (x^j mod f) for j < m, the powers of alpha = x go by one multiplication by x each
+		typedef typename std::conditional<(Zp < 256), uint8_t, uint32_t>::type digit;
+		std::vector<digit> u(m);
+		if (Zp == 2 && Deg < 64)
+		{
+			// x^Deg = f - x^Deg in characteristic 2, one shift and one XOR per power
+			uint64_t state = 1, top = uint64_t(1) << Deg, reduction = top;
+			for (size_t i = 0; i < Deg; ++i)
+				reduction |= uint64_t(f[i]) << i;
+			for (size_t j = 0; j < m; ++j)
+			{
+				u[j] = digit(state & 1);
+				state <<= 1;
+				if (state & top)
+					state ^= reduction;
+			}
+		}
+		else
+		{
+			std::vector<size_t> state(Deg);
+			state[0] = 1;
+			for (size_t j = 0; j < m; ++j)
+			{
+				u[j] = digit(state[0]);
+				size_t carry = state[Deg - 1];
+				for (size_t i = Deg - 1; i > 0; --i)
+					state[i] = (state[i - 1] + Zp - mulmod(carry, f[i], Zp)) % Zp;
+				state[0] = (Zp - mulmod(carry, f[0], Zp)) % Zp;
+			}
+		}
+
+		// the coset of k is {k, k Zp, k Zp^2, ...} mod m, alpha^k has a minimal polynomial of degree Deg iff it has Deg elements.
+		// u[k j] is a nonzero linear map of (alpha^k)^j, so its shortest recurrence is that minimal polynomial
+		// sorted by their position in consecutive order at the end
+		std::vector<std::pair<size_t, Polynomial<Zp>>> found;
+		std::vector<bool> visited(m);
+		std::vector<ModInt<Zp>> s(2 * Deg);
+		for (size_t k = 0; k < m; ++k)
+		{
+			if (visited[k])
+				continue;
+			size_t size = 0, j = k;
+			do
+			{
+				visited[j] = true;
+				j = j * Zp % m;
+				++size;
+			}
+			while (j != k);
+			if (size != Deg)
+				continue;
+			for (size_t i = 0, idx = 0; i < s.size(); ++i, idx = (idx + k) % m)
+				s[i] = ModInt<Zp>(static_cast<uint64_t>(u[idx]));
+			Polynomial<Zp> p = BerlekampMassey(s);
+			found.emplace_back(generator::Index(p), std::move(p));
+		}
+		// 0 is not a power of alpha
+		if (Deg == 1)
+			found.emplace_back(0, Polynomial<Zp>::X);
+		std::sort(found.begin(), found.end(), [](const std::pair<size_t, Polynomial<Zp>>& a, const std::pair<size_t, Polynomial<Zp>>& b)
+		{
+			return a.first < b.first;
+		});
+		std::vector<Polynomial<Zp>> res;
+		res.reserve(found.size());
+		for (auto& p : found)
+			res.push_back(std::move(p.second));
+		return res;
+	}
+
+	template <size_t Zp, size_t Deg>
+	std::vector<std::pair<Polynomial<Zp>, size_t>> GaloisFieldExtension<Zp, Deg>::FactorizeByFieldElements(const Polynomial<Zp>& poly) const
+	{
+		return PolynomialFactorizer<Zp>()(poly);
 	}
 
 	template <size_t Zp, size_t Deg>
 	GaloisFieldExtension<Zp, Deg> GaloisFieldExtension<Zp, Deg>::Build(const Polynomial<Zp>& factor, bool test_irreducibilty)
 	{
-		if (test_irreducibilty && TestIrreducibility(factor))
+		if (test_irreducibilty && !TestIrreducibility(factor))
 			throw std::runtime_error("Given polynomial is reducible");
 		return BuildFactorGroup(factor);
 	}
@@ -326,17 +952,21 @@ namespace Algebra
 	template <size_t Zp, size_t Deg>
 	void GaloisFieldExtension<Zp, Deg>::PrintPretty(std::ostream& s, bool print_elements) const
 	{
-		s << "Field GF(" << Zp << "^" << Deg << ")" << " [ " << this->order() << " elements ]" << std::endl;
+		s << "Field GF(" << Zp << "^" << Deg << ")";
+		if (lazy())
+			s << " [ " << Zp << "^" << factor_.deg() << " elements, lazy ]" << std::endl;
+		else
+			s << " [ " << this->order() << " elements ]" << std::endl;
 		s << "Generator: " << generator_ << std::endl;
 		s << "Irreducible polynomial as factor: " << factor_ << std::endl;
-		if (print_elements)
+		if (print_elements && !lazy())
 		{
 			size_t sz = m_order();
 			s << "Elements of multiplicative group (" << sz << " elements ): " << std::endl;
 			auto space = log10(sz) + 1;
 			for (size_t i = 0; i < sz; ++i)
 			{
-				s << "a^" << std::setw(space) << i << " : " << elements_[i] << std::endl;
+				s << "a^" << std::setw(space) << i << " : " << (*this)[i] << std::endl;
 			}
 		}
 	}
@@ -0,0 +1,239 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include "Multiplication.h"
+#include "Division.h"
+
+
+namespace Algebra
+{
+	// Extended Euclid for polynomials over a coefficient ring (ModularRing<Zp>, MontgomeryRing, ...):
+	// half-GCD in O(M(n) log n) when the larger operand has at least HalfGcdThreshold coefficients,
+	// the classical remainder sequence with one division per step below. Both give the same remainders.
+	// Every remainder has to have an invertible leading coefficient (always true over a field), otherwise it gives up.
+	template <class Ring>
+	class Euclid
+	{
+		typedef typename Ring::value_type T;
+		// coefficients without high zeros, zero polynomial is empty
+		typedef std::vector<T> poly;
+		// 2x2 polynomial matrix acting on the column (a, b)
+		typedef std::array<std::array<poly, 2>, 2> matrix;
+
+		Ring ring_;
+
+		static void		trim			(poly& p);
+		// p div x^k
+		static poly		high			(const poly& p, size_t k);
+
+		poly			mul				(const poly& a, const poly& b)	const;
+		// acc += a * b (-= when subtract) in place, without a product temporary
+		void			addmul			(poly& acc, const poly& a, const poly& b, bool subtract = false) const;
+		matrix			identity		()								const;
+		matrix			mul				(const matrix& x, const matrix& y) const;
+		// (a, b) <- m * (a, b)
+		void			apply			(const matrix& m, poly& a, poly& b) const;
+		// (a, b) <- (b, a mod b) and m <- [[0, 1], [1, -(a div b)]] * m when m is given; false if lead of b is not invertible
+		bool			step			(poly& a, poly& b, matrix* m)	const;
+		// res * (a, b) = (a', b') with deg b' < ceil(deg a / 2) <= deg a'
+		bool			half_gcd		(poly a, poly b, matrix& res)	const;
+
+	public:
+		// Operands with less coefficients go by the classical remainder sequence
+		static size_t						HalfGcdThreshold;
+		// Inside half-GCD, operands with less coefficients are reduced by classical steps instead of splitting further
+		static size_t						HalfGcdBaseThreshold;
+
+		explicit Euclid					(const Ring& ring = Ring());
+
+		// g = gcd(a, b), the last non-zero remainder of a and b (empty if both are zero),
+		// and u * a + v * b = g when u, v are given. False if a remainder has a non-invertible leading coefficient.
+		bool			operator()		(const T* a, size_t na, const T* b, size_t nb, std::vector<T>& g,
+										 std::vector<T>* u = nullptr, std::vector<T>* v = nullptr) const;
+	};
+
+	/////////////// CONSTANT DEFINTION
+
+	template <class Ring>
+	size_t Euclid<Ring>::HalfGcdThreshold = 2048;
+
+	template <class Ring>
+	size_t Euclid<Ring>::HalfGcdBaseThreshold = 256;
+
+	/////////////// IMPLEMENTATION
+
+	template <class Ring>
+	Euclid<Ring>::Euclid(const Ring& ring) : ring_(ring)
+	{
+	}
+
+	template <class Ring>
+	void Euclid<Ring>::trim(poly& p)
+	{
+		while (!p.empty() && p.back() == T())
+			p.pop_back();
+	}
+
+	template <class Ring>
+	typename Euclid<Ring>::poly Euclid<Ring>::high(const poly& p, size_t k)
+	{
+		return k < p.size() ? poly(p.begin() + k, p.end()) : poly();
+	}
+
+	template <class Ring>
+	typename Euclid<Ring>::poly Euclid<Ring>::mul(const poly& a, const poly& b) const
+	{
+		if (a.empty() || b.empty())
+			return poly();
+		poly res(a.size() + b.size() - 1);
+		Multiplier<Ring> multiply(ring_);
+		multiply(a.data(), a.size(), b.data(), b.size(), res.data());
+		trim(res);
+		return res;
+	}
+
+	template <class Ring>
+	void Euclid<Ring>::addmul(poly& acc, const poly& a, const poly& b, bool subtract) const
+	{
+		if (a.empty() || b.empty())
+			return;
+		if (acc.size() < a.size() + b.size() - 1)
+			acc.resize(a.size() + b.size() - 1);
+		Multiplier<Ring> multiply(ring_);
+		multiply.accumulate(a.data(), a.size(), b.data(), b.size(), acc.data(), subtract);
+		trim(acc);
+	}
+
+	template <class Ring>
+	typename Euclid<Ring>::matrix Euclid<Ring>::identity() const
+	{
+		matrix res;
+		res[0][0] = res[1][1] = poly(1, ring_.from(1));
+		return res;
+	}
+
+	template <class Ring>
+	typename Euclid<Ring>::matrix Euclid<Ring>::mul(const matrix& x, const matrix& y) const
+	{
+		matrix res;
+		for (size_t i = 0; i < 2; ++i)
+		{
+			for (size_t j = 0; j < 2; ++j)
+			{
+				res[i][j] = mul(x[i][0], y[0][j]);
+				addmul(res[i][j], x[i][1], y[1][j]);
+			}
+		}
+		return res;
+	}
+
+	template <class Ring>
+	void Euclid<Ring>::apply(const matrix& m, poly& a, poly& b) const
+	{
+		poly first = mul(m[0][0], a);
+		addmul(first, m[0][1], b);
+		poly second = mul(m[1][0], a);
+		addmul(second, m[1][1], b);
+		a.swap(first);
+		b.swap(second);
+	}
+
+	template <class Ring>
+	bool Euclid<Ring>::step(poly& a, poly& b, matrix* m) const
+	{
+		if (!ring_.invertible(b.back()))
+			return false;
+		// the quotient only goes into the matrix, its buffer is kept per thread
+		static thread_local poly q;
+		q.clear();
+		if (a.size() >= b.size())
+		{
+			if (m)
+				q.resize(a.size() - b.size() + 1);
+			Divider<Ring> divide(ring_);
+			divide(a.data(), a.size(), b.data(), b.size(), m ? q.data() : nullptr);
+			a.resize(b.size() - 1);
+			trim(a);
+		}
+		// a is the remainder now
+		a.swap(b);
+		if (m)
+		{
+			for (size_t j = 0; j < 2; ++j)
+			{
+				addmul((*m)[0][j], q, (*m)[1][j], true);
+				(*m)[0][j].swap((*m)[1][j]);
+			}
+		}
+		return true;
+	}
+
+	template <class Ring>
+	bool Euclid<Ring>::half_gcd(poly a, poly b, matrix& res) const
+	{
+		res = identity();
+		size_t m = a.size() / 2;
+		if (b.size() <= m)
+			return true;
+		if (a.size() < HalfGcdBaseThreshold)
+		{
+			while (b.size() > m)
+			{
+				if (!step(a, b, &res))
+					return false;
+			}
+			return true;
+		}
+
+		// quotients of the high halves are the first quotients of a and b
+		if (!half_gcd(high(a, m), high(b, m), res))
+			return false;
+		apply(res, a, b);
+		if (b.size() <= m)
+			return true;
+		if (!step(a, b, &res))
+			return false;
+		if (b.size() <= m)
+			return true;
+		size_t k = 2 * m + 1 > a.size() ? 2 * m + 1 - a.size() : 0;
+		matrix rest;
+		if (!half_gcd(high(a, k), high(b, k), rest))
+			return false;
+		res = mul(rest, res);
+		return true;
+	}
+
+	template <class Ring>
+	bool Euclid<Ring>::operator()(const T* a, size_t na, const T* b, size_t nb, std::vector<T>& g, std::vector<T>* u, std::vector<T>* v) const
+	{
+		poly x(a, a + na), y(b, b + nb);
+		trim(x);
+		trim(y);
+		bool cofactors = u || v;
+		matrix m = identity();
+		while (!y.empty())
+		{
+			if (x.size() >= HalfGcdThreshold && x.size() > y.size())
+			{
+				matrix h;
+				if (!half_gcd(x, y, h))
+					return false;
+				apply(h, x, y);
+				if (cofactors)
+					m = mul(h, m);
+				if (y.empty())
+					break;
+			}
+			if (!step(x, y, cofactors ? &m : nullptr))
+				return false;
+		}
+		g.swap(x);
+		if (u)
+			*u = m[0][0];
+		if (v)
+			*v = m[0][1];
+		return true;
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include "Algebra.h"
+
+
+namespace Algebra
+{
+	// m^-1 mod 2^64 for odd m: x = m is correct in 3 bits, every Newton step doubles that
+	constexpr uint64_t newton_inverse(uint64_t m, uint64_t x, int steps)
+	{
+		return steps ? newton_inverse(m, x * (2 - m * x), steps - 1) : x;
+	}
+
+	// x mod m for x < 2m
+	constexpr uint64_t subtract_once(uint64_t x, uint64_t m)
+	{
+		return x >= m ? x - m : x;
+	}
+
+	// 2x mod m for x < m
+	constexpr uint64_t double_mod(uint64_t x, uint64_t m)
+	{
+		return x >= m - x ? x - (m - x) : x + x;
+	}
+
+	// 2^k mod m by k doublings
+	constexpr uint64_t pow2mod(unsigned k, uint64_t m)
+	{
+		return k == 0 ? 1 % m : double_mod(pow2mod(k - 1, m), m);
+	}
+
+	// (hi * 2^64 + lo) * 2^-64 mod m for odd m < 2^63 and hi < m, factor = -m^-1 mod 2^64
+	constexpr uint64_t montgomery_reduce(uint64_t hi, uint64_t lo, uint64_t m, uint64_t factor)
+	{
+		return subtract_once(hi + mulhi(lo * factor, m) + (lo != 0), m);
+	}
+
+	// Element of Z/Zp stored in the narrowest unsigned type which holds Zp - 1.
+	// Moduli up to 2^32 are reduced by Barrett's method, odd moduli below 2^63 by Montgomery's,
+	// every reduction constant is computed at compile time.
+	template <size_t Zp>
+	class ModInt
+	{
+		static_assert(Zp > 1, "Zp cannot be less than 2");
+
+	public:
+		typedef typename std::conditional<(Zp <= 0x100), uint8_t,
+			typename std::conditional<(Zp <= 0x10000), uint16_t,
+			typename std::conditional<(uint64_t(Zp) <= 0x100000000ull), uint32_t, uint64_t>::type>::type>::type storage_type;
+
+		// Product of two reduced values fits into 64 bits
+		static const bool				Narrow = uint64_t(Zp) <= 0x100000000ull;
+
+	private:
+		static const bool				Montgomery = !Narrow && Zp % 2 == 1 && uint64_t(Zp) < (uint64_t(1) << 63);
+		// floor((2^64 - 1) / Zp), Barrett's quotient is at most one less than the true one
+		static const uint64_t			BarrettFactor = ~uint64_t(0) / Zp;
+		static const uint64_t			MontgomeryFactor = 0 - newton_inverse(Zp, Zp, 5);	// -Zp^-1 mod R
+		// R^2 mod Zp for R = 2^64
+		static const uint64_t			MontgomerySquare = pow2mod(128, Zp);
+
+		storage_type value_;
+
+		struct raw {};
+		constexpr ModInt				(storage_type value, raw) : value_(value) {}
+
+		static constexpr uint64_t	correct			(uint64_t a)				{ return a >= Zp ? a - Zp : a; }
+		static constexpr uint64_t	add				(uint64_t a, uint64_t b)	{ return a >= Zp - b ? a - (Zp - b) : a + b; }
+		static constexpr uint64_t	barrett			(uint64_t a)				{ return correct(a - mulhi(a, BarrettFactor) * Zp); }
+		static constexpr uint64_t	redc			(uint64_t hi, uint64_t lo)	{ return montgomery_reduce(hi, lo, Zp, MontgomeryFactor); }
+		// a * b / R * R^2 / R = a * b
+		static constexpr uint64_t	lift			(uint64_t a)				{ return redc(mulhi(a, MontgomerySquare), a * MontgomerySquare); }
+		static constexpr uint64_t	montgomery		(uint64_t a, uint64_t b)	{ return lift(redc(mulhi(a, b), a * b)); }
+		// double-and-add for wide moduli Montgomery does not handle
+		static constexpr uint64_t	doubled			(uint64_t a, uint64_t half, bool odd)	{ return add(add(half, half), odd ? a : 0); }
+		static constexpr uint64_t	slow			(uint64_t a, uint64_t b)	{ return b == 0 ? 0 : doubled(a, slow(a, b >> 1), b & 1); }
+		static constexpr uint64_t	multiply		(uint64_t a, uint64_t b)
+		{
+			return Narrow ? barrett(a * b) : Montgomery ? montgomery(a, b) : slow(a, b);
+		}
+		static constexpr uint64_t	from_unsigned	(uint64_t a)				{ return Narrow ? barrett(a) : a % Zp; }
+		static constexpr uint64_t	from_signed		(long long a)
+		{
+			return a >= 0 ? from_unsigned(uint64_t(a)) : Zp - 1 - from_unsigned(uint64_t(-(a + 1)));
+		}
+
+	public:
+		constexpr ModInt				() : value_(0) {}
+
+		template <class Integer, class = typename std::enable_if<std::is_integral<Integer>::value>::type>
+		constexpr explicit ModInt		(Integer value) :
+			value_(storage_type(std::is_signed<Integer>::value ? from_signed(static_cast<long long>(value)) : from_unsigned(uint64_t(value))))
+		{
+		}
+
+		// value has to be less than Zp already
+		static constexpr ModInt		Raw				(storage_type value)		{ return ModInt(value, raw()); }
+		// Reduces any 64-bit number, used to reduce lazily accumulated products of Narrow values
+		static constexpr ModInt		Reduce			(uint64_t value)			{ return ModInt(storage_type(from_unsigned(value)), raw()); }
+
+		constexpr storage_type		value			()							const { return value_; }
+		constexpr explicit operator bool			()							const { return value_ != 0; }
+
+		constexpr ModInt			operator +		(ModInt a)					const { return ModInt(storage_type(add(value_, a.value_)), raw()); }
+		constexpr ModInt			operator -		(ModInt a)					const { return *this + -a; }
+		constexpr ModInt			operator -		()							const { return ModInt(storage_type(value_ ? Zp - value_ : 0), raw()); }
+		constexpr ModInt			operator *		(ModInt a)					const { return ModInt(storage_type(multiply(value_, a.value_)), raw()); }
+
+		ModInt&						operator +=		(ModInt a)					{ return *this = *this + a; }
+		ModInt&						operator -=		(ModInt a)					{ return *this = *this - a; }
+		ModInt&						operator *=		(ModInt a)					{ return *this = *this * a; }
+
+		constexpr bool				operator ==		(ModInt a)					const { return value_ == a.value_; }
+		constexpr bool				operator !=		(ModInt a)					const { return value_ != a.value_; }
+
+		// O(log e)
+		constexpr ModInt			pow				(uint64_t e)				const
+		{
+			return e == 0 ? ModInt(1) : (*this * *this).pow(e >> 1) * (e & 1 ? *this : ModInt(1));
+		}
+		// Throws if the value has no inverse (is not coprime to Zp)
+		ModInt						inverse			()							const;
+
+		friend std::ostream& operator << (std::ostream &s, ModInt a)
+		{
+			return s << uint64_t(a.value_);
+		}
+	};
+
+	/////////////// IMPLEMENTATION
+
+	template <size_t Zp>
+	ModInt<Zp> ModInt<Zp>::inverse() const
+	{
+		if (gcd(value_, Zp) != 1)
+			throw std::runtime_error("Element is not invertible");
+		return ModInt(storage_type(inverse_mod(value_, Zp)), raw());
+	}
+}
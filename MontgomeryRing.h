@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include "Algebra.h"
+#include "ModInt.h"
+#include "MultiModularTransform.h"
+
+
+namespace Algebra
+{
+	// Arithmetic of Z/m for an odd modulus 3 <= m < 2^63 chosen at runtime.
+	// Values are kept in Montgomery form a * 2^64 mod m, products use 128-bit intermediates.
+	// Same interface as ModularRing<Zp>, so it plugs into Multiplier and Divider.
+	class MontgomeryRing
+	{
+		uint64_t modulus_;
+		uint64_t factor_;		// -m^-1 mod 2^64
+		uint64_t square_;		// 2^128 mod m
+		uint64_t accumulate_limit_;
+
+	public:
+		typedef uint64_t value_type;
+
+		explicit MontgomeryRing			(uint64_t modulus);
+
+		size_t			modulus			()							const { return size_t(modulus_); }
+
+		value_type		add				(value_type a, value_type b) const { return a >= modulus_ - b ? a - (modulus_ - b) : a + b; }
+		value_type		sub				(value_type a, value_type b) const { return a >= b ? a - b : a + (modulus_ - b); }
+		value_type		mul				(value_type a, value_type b) const { return montgomery_reduce(mulhi(a, b), a * b, modulus_, factor_); }
+		value_type		from			(uint64_t a)				const;
+		value_type		from_signed		(long long a)				const;
+		// Throws if a is not coprime to the modulus
+		value_type		inverse			(value_type a)				const;
+		// a * R is coprime to the modulus iff a is, R = 2^64 is
+		bool			invertible		(value_type a)				const { return gcd(a, modulus_) == 1; }
+		// Back from Montgomery form, 0 <= result < modulus
+		uint64_t		get				(value_type a)				const { return montgomery_reduce(0, a, modulus_, factor_); }
+
+		// Lazy accumulation is possible only for moduli up to 2^32, limit is 0 otherwise
+		uint64_t		accumulate_limit()							const { return accumulate_limit_; }
+		uint64_t		product			(value_type a, value_type b) const { return a * b; }
+		// sum of products a * R * b * R becomes (a * b) * R after one reduction
+		value_type		reduce			(uint64_t a)				const { return montgomery_reduce(0, a, modulus_, factor_); }
+
+		// the modulus is only known at runtime, so only the multi-modular transform applies
+		bool			direct_transform(size_t)					const { return false; }
+		// Multi-modular transform for moduli below 2^32, false otherwise
+		bool			transform_multiply(const value_type* a, size_t na, const value_type* b, size_t nb, value_type* res) const;
+
+		bool			operator ==		(const MontgomeryRing& r)	const { return modulus_ == r.modulus_; }
+		bool			operator !=		(const MontgomeryRing& r)	const { return modulus_ != r.modulus_; }
+	};
+
+	/////////////// IMPLEMENTATION
+
+	inline MontgomeryRing::MontgomeryRing(uint64_t modulus) :
+		modulus_(modulus)
+	{
+		if (modulus < 3 || modulus % 2 == 0 || modulus >> 63)
+			throw std::runtime_error("Montgomery arithmetic needs an odd modulus between 3 and 2^63");
+		factor_ = 0 - newton_inverse(modulus, modulus, 5);
+		square_ = pow2mod(128, modulus);
+		accumulate_limit_ = modulus >> 32 ? 0 : std::numeric_limits<uint64_t>::max() / ((modulus - 1) * (modulus - 1));
+	}
+
+	inline MontgomeryRing::value_type MontgomeryRing::from(uint64_t a) const
+	{
+		a %= modulus_;
+		return montgomery_reduce(mulhi(a, square_), a * square_, modulus_, factor_);
+	}
+
+	inline MontgomeryRing::value_type MontgomeryRing::from_signed(long long a) const
+	{
+		value_type magnitude = from(a < 0 ? uint64_t(-(a + 1)) + 1 : uint64_t(a));
+		return a < 0 ? sub(0, magnitude) : magnitude;
+	}
+
+	inline MontgomeryRing::value_type MontgomeryRing::inverse(value_type a) const
+	{
+		uint64_t value = get(a);
+		if (gcd(value, modulus_) != 1)
+			throw std::runtime_error("Element is not invertible");
+		return from(inverse_mod(value, modulus_));
+	}
+
+	inline bool MontgomeryRing::transform_multiply(const value_type* a, size_t na, const value_type* b, size_t nb, value_type* res) const
+	{
+		if (modulus_ >> 32 || !MultiModularTransform::Supported(na + nb - 1, std::min(na, nb), modulus_ - 1))
+			return false;
+		std::vector<uint32_t> ta(na), tb(nb), product(na + nb - 1);
+		for (size_t i = 0; i < na; ++i)
+			ta[i] = uint32_t(get(a[i]));
+		bool square = a == b && na == nb;
+		for (size_t i = 0; i < nb && !square; ++i)
+			tb[i] = uint32_t(get(b[i]));
+		MultiModularTransform::Multiply(ta.data(), na, square ? ta.data() : tb.data(), nb, product.data(), uint32_t(modulus_));
+		for (size_t i = 0, sz = product.size(); i < sz; ++i)
+			res[i] = from(product[i]);
+		return true;
+	}
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include "NumberTheoreticTransform.h"
+
+
+namespace Algebra
+{
+	// Multiplication of polynomials with arbitrary (non-negative or signed) integer coefficients
+	// modulo three NTT primes and reconstruction of every coefficient by the Chinese Remainder Theorem.
+	// Gives fast multiplication for any Zp without roots of unity and an exact product in Z[x].
+	class MultiModularTransform
+	{
+		static const uint32_t P1 = 998244353;	// 119 * 2^23 + 1
+		static const uint32_t P2 = 167772161;	// 5 * 2^25 + 1
+		static const uint32_t P3 = 469762049;	// 7 * 2^26 + 1
+
+		typedef NumberTheoreticTransform<P1> Transform1;
+		typedef NumberTheoreticTransform<P2> Transform2;
+		typedef NumberTheoreticTransform<P3> Transform3;
+
+		// Mixed radix digits of x mod P1*P2*P3: x = t1 + P1 * t2 + P1 * P2 * t3
+		struct Digits
+		{
+			uint64_t t1, t2, t3;
+		};
+
+		static uint64_t		power			(uint64_t a, uint64_t e, uint64_t m);
+
+		// r_i = a * b mod P_i for every prime, a and b are already reduced modulo each prime
+		static void			Residues		(const std::vector<uint32_t> (&a)[3], const std::vector<uint32_t> (&b)[3], std::vector<uint32_t> (&r)[3]);
+		static Digits		Garner			(uint32_t r1, uint32_t r2, uint32_t r3);
+
+	public:
+		// Longest product which can be computed
+		static size_t		MaxLength		();
+		// Result is exact if every coefficient of a * b is less than P1*P2*P3 (about 2^86)
+		static bool			Supported		(size_t result_length, size_t shortest_length, uint64_t max_coefficient);
+
+		// res[0 .. na + nb - 1) = a * b mod modulus, coefficients are less than 2^32
+		static void			Multiply		(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* res, uint32_t modulus);
+
+		// Exact product in Z[x]. Throws if coefficients of the result could overflow 63 bits.
+		static std::vector<long long> MultiplyExact(const std::vector<long long>& a, const std::vector<long long>& b);
+	};
+
+	/////////////// IMPLEMENTATION
+
+	inline uint64_t MultiModularTransform::power(uint64_t a, uint64_t e, uint64_t m)
+	{
+		uint64_t res = 1;
+		a %= m;
+		while (e)
+		{
+			if (e & 1)
+				res = res * a % m;
+			a = a * a % m;
+			e >>= 1;
+		}
+		return res;
+	}
+
+	inline size_t MultiModularTransform::MaxLength()
+	{
+		return std::min(Transform1::MaxLength(), std::min(Transform2::MaxLength(), Transform3::MaxLength()));
+	}
+
+	inline bool MultiModularTransform::Supported(size_t result_length, size_t shortest_length, uint64_t max_coefficient)
+	{
+		if (result_length > MaxLength() || max_coefficient >> 32)
+			return false;
+		long double bound = static_cast<long double>(shortest_length) * max_coefficient * max_coefficient;
+		return bound < static_cast<long double>(P1) * P2 * P3;
+	}
+
+	inline void MultiModularTransform::Residues(const std::vector<uint32_t> (&a)[3], const std::vector<uint32_t> (&b)[3], std::vector<uint32_t> (&r)[3])
+	{
+		size_t na = a[0].size(), nb = b[0].size();
+		for (auto& residue : r)
+			residue.resize(na + nb - 1);
+		Transform1::Multiply(a[0].data(), na, b[0].data(), nb, r[0].data());
+		Transform2::Multiply(a[1].data(), na, b[1].data(), nb, r[1].data());
+		Transform3::Multiply(a[2].data(), na, b[2].data(), nb, r[2].data());
+	}
+
+	inline MultiModularTransform::Digits MultiModularTransform::Garner(uint32_t r1, uint32_t r2, uint32_t r3)
+	{
+		static const uint64_t inv_p1_mod_p2 = power(P1, P2 - 2, P2);
+		static const uint64_t inv_p1p2_mod_p3 = power(uint64_t(P1) * P2 % P3, P3 - 2, P3);
+
+		Digits d;
+		d.t1 = r1;
+		d.t2 = (r2 + P2 - d.t1 % P2) % P2 * inv_p1_mod_p2 % P2;
+		uint64_t partial = (d.t1 + uint64_t(P1) * d.t2) % P3;
+		d.t3 = (r3 + P3 - partial) % P3 * inv_p1p2_mod_p3 % P3;
+		return d;
+	}
+
+	inline void MultiModularTransform::Multiply(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* res, uint32_t modulus)
+	{
+		static const uint32_t primes[3] = { P1, P2, P3 };
+		std::vector<uint32_t> ra[3], rb[3], r[3];
+		// squaring hands the same residues twice, so every prime transforms the operand once
+		bool square = a == b && na == nb;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			ra[i].resize(na);
+			for (size_t j = 0; j < na; ++j)
+				ra[i][j] = a[j] % primes[i];
+			if (square)
+				continue;
+			rb[i].resize(nb);
+			for (size_t j = 0; j < nb; ++j)
+				rb[i][j] = b[j] % primes[i];
+		}
+		Residues(ra, square ? ra : rb, r);
+
+		const uint64_t m = modulus, p1 = P1 % m, p1p2 = uint64_t(P1) * P2 % m;
+		for (size_t i = 0, sz = na + nb - 1; i < sz; ++i)
+		{
+			auto d = Garner(r[0][i], r[1][i], r[2][i]);
+			res[i] = uint32_t((d.t1 % m + p1 * (d.t2 % m) % m + p1p2 * (d.t3 % m) % m) % m);
+		}
+	}
+
+	inline std::vector<long long> MultiModularTransform::MultiplyExact(const std::vector<long long>& a, const std::vector<long long>& b)
+	{
+		if (a.empty() || b.empty())
+			return{};
+		auto magnitude = [](const std::vector<long long>& v)
+		{
+			long double largest = 0;
+			for (auto c : v)
+				largest = std::max(largest, std::abs(static_cast<long double>(c)));
+			return largest;
+		};
+		// every coefficient is bounded by min(na, nb) * max|a| * max|b|, that has to fit in 63 bits
+		long double bound = magnitude(a) * magnitude(b) * std::min(a.size(), b.size());
+		if (bound >= 9.2e18L || a.size() + b.size() - 1 > MaxLength())
+			throw std::runtime_error("Exact product does not fit into 64-bit coefficients");
+
+		static const uint32_t primes[3] = { P1, P2, P3 };
+		std::vector<uint32_t> ra[3], rb[3], r[3];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			auto lift = [&](const std::vector<long long>& v, std::vector<uint32_t>& residue)
+			{
+				residue.resize(v.size());
+				for (size_t j = 0, sz = v.size(); j < sz; ++j)
+				{
+					long long c = v[j] % static_cast<long long>(primes[i]);
+					residue[j] = uint32_t(c < 0 ? c + primes[i] : c);
+				}
+			};
+			lift(a, ra[i]);
+			lift(b, rb[i]);
+		}
+		Residues(ra, rb, r);
+
+		// values above (P1*P2*P3 - 1) / 2 are negative, its digits are ((P1-1)/2, (P2-1)/2, (P3-1)/2)
+		const uint64_t modulus_low = uint64_t(P1) * P2 * P3;	// P1*P2*P3 mod 2^64
+		std::vector<long long> res(a.size() + b.size() - 1);
+		for (size_t i = 0, sz = res.size(); i < sz; ++i)
+		{
+			auto d = Garner(r[0][i], r[1][i], r[2][i]);
+			bool negative = d.t3 != (P3 - 1) / 2 ? d.t3 > (P3 - 1) / 2 :
+				d.t2 != (P2 - 1) / 2 ? d.t2 > (P2 - 1) / 2 : d.t1 > (P1 - 1) / 2;
+			// arithmetic modulo 2^64 is exact as the true value fits in 63 bits
+			uint64_t value = d.t1 + uint64_t(P1) * d.t2 + uint64_t(P1) * P2 * d.t3;
+			if (negative)
+				value -= modulus_low;
+			res[i] = static_cast<long long>(value);
+		}
+		return res;
+	}
+}
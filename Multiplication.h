@@ -0,0 +1,411 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include "Algebra.h"
+#include "ModInt.h"
+#include "NumberTheoreticTransform.h"
+#include "MultiModularTransform.h"
+
+
+namespace Algebra
+{
+	enum class MULTIPLICATION_ALGORITHM
+	{
+		AUTO,
+		SCHOOLBOOK,
+		KARATSUBA,
+		TOOM3,
+		NTT
+	};
+
+	// Arithmetic of Z/Zp as seen by multiplication kernels.
+	// Products are accumulated as 64-bit numbers and reduced lazily, after at most AccumulateLimit additions.
+	// AccumulateLimit is 0 when a single product does not fit into 64 bits.
+	template <size_t Zp>
+	class ModularRing
+	{
+	public:
+		typedef ModInt<Zp> value_type;
+
+		static const uint64_t AccumulateLimit = value_type::Narrow ?
+			std::numeric_limits<uint64_t>::max() / (value_type::Narrow ? uint64_t(Zp - 1) * (Zp - 1) : 1) : 0;
+
+		size_t			modulus			()							const { return Zp; }
+		uint64_t		accumulate_limit()							const { return AccumulateLimit; }
+
+		value_type		add				(value_type a, value_type b) const { return a + b; }
+		value_type		sub				(value_type a, value_type b) const { return a - b; }
+		value_type		mul				(value_type a, value_type b) const { return a * b; }
+		value_type		from			(uint64_t a)				const { return value_type(a); }
+		value_type		inverse			(value_type a)				const { return a.inverse(); }
+		bool			invertible		(value_type a)				const { return gcd(a.value(), Zp) == 1; }
+
+		uint64_t		product			(value_type a, value_type b) const { return uint64_t(a.value()) * b.value(); }
+		value_type		reduce			(uint64_t a)				const { return value_type::Reduce(a); }
+
+		// A product of n coefficients goes through one transform modulo Zp itself, not through the multi-modular one
+		bool			direct_transform(size_t n)					const { return !(uint64_t(Zp) >> 32) && NumberTheoreticTransform<Zp>::Supported(n); }
+
+		// Multiplication by number-theoretic transform: directly when Zp is NTT-friendly,
+		// otherwise modulo three NTT primes with reconstruction by CRT. False if neither applies.
+		bool			transform_multiply(const value_type* a, size_t na, const value_type* b, size_t nb, value_type* res) const
+		{
+			// residues are handed over as 32-bit numbers
+			if (uint64_t(Zp) >> 32)
+				return false;
+			bool direct = direct_transform(na + nb - 1);
+			if (!direct && !MultiModularTransform::Supported(na + nb - 1, std::min(na, nb), Zp - 1))
+				return false;
+			std::vector<uint32_t> ta(na), tb(nb), product(na + nb - 1);
+			for (size_t i = 0; i < na; ++i)
+				ta[i] = uint32_t(a[i].value());
+			for (size_t i = 0; i < nb; ++i)
+				tb[i] = uint32_t(b[i].value());
+			const std::vector<uint32_t>& second = a == b && na == nb ? ta : tb;
+			if (direct)
+				NumberTheoreticTransform<Zp>::Multiply(ta.data(), na, second.data(), nb, product.data());
+			else
+				MultiModularTransform::Multiply(ta.data(), na, second.data(), nb, product.data(), uint32_t(Zp));
+			for (size_t i = 0, sz = product.size(); i < sz; ++i)
+				res[i] = value_type::Raw(typename value_type::storage_type(product[i]));
+			return true;
+		}
+	};
+
+	// Polynomial multiplication engine over a coefficient ring:
+	// schoolbook for short operands, Karatsuba above KaratsubaThreshold, Toom-3 above ToomThreshold,
+	// number-theoretic transform above NttThreshold (MultiModularThreshold for the three-prime CRT one) when the ring supports it.
+	// Works in one scratch buffer, which is kept per thread and grown only when needed.
+	// Squaring is recognized by a == b: every kernel then evaluates and transforms the operand once.
+	template <class Ring>
+	class Multiplier
+	{
+		typedef typename Ring::value_type T;
+
+		Ring ring_;
+
+	protected:
+		bool			toom_supported	()							const;
+
+		// k-th coefficient of a * b, products are summed lazily
+		T				convolution		(const T* a, size_t na, const T* b, size_t nb, size_t k) const;
+		void			schoolbook		(const T* a, size_t na, const T* b, size_t nb, T* res) const;
+		// res[0 .. 2n - 1) = a^2: every cross product a[i] * a[j], i < j, is computed once and doubled
+		void			schoolbook_square(const T* a, size_t n, T* res)		const;
+		// res[0 .. 2n - 1) = a * b, both operands have n coefficients
+		void			balanced		(const T* a, const T* b, size_t n, T* res, T* scratch) const;
+		void			karatsuba		(const T* a, const T* b, size_t n, T* res, T* scratch) const;
+		void			toom3			(const T* a, const T* b, size_t n, T* res, T* scratch) const;
+		// scratch needed by balanced(n)
+		size_t			scratch_size	(size_t n)					const;
+
+	public:
+		// Operands with less coefficients are multiplied by schoolbook method
+		static size_t						KaratsubaThreshold;
+		// Operands with at least that many coefficients are split in 3 parts instead of 2
+		static size_t						ToomThreshold;
+		// Operands with at least that many coefficients are multiplied by transform modulo Zp, if ring allows
+		static size_t						NttThreshold;
+		// The same for the multi-modular transform (three NTT primes and CRT), which costs about three transforms more
+		static size_t						MultiModularThreshold;
+		// Forces one algorithm (down to KaratsubaThreshold, NTT falls back when ring has no transform), AUTO picks one by operand size
+		static MULTIPLICATION_ALGORITHM		Algorithm;
+
+		explicit Multiplier				(const Ring& ring = Ring());
+
+		// res[0 .. na + nb - 1) = a * b, a == b && na == nb squares
+		void			operator()		(const T* a, size_t na, const T* b, size_t nb, T* res) const;
+		// acc[0 .. na + nb - 1) += a * b (-= when subtract), acc must not overlap a or b.
+		// Below KaratsubaThreshold every coefficient goes straight into acc, above the product is kept in a per-thread buffer
+		void			accumulate		(const T* a, size_t na, const T* b, size_t nb, T* acc, bool subtract = false) const;
+	};
+
+	/////////////// CONSTANT DEFINTION
+
+	template <class Ring>
+	size_t Multiplier<Ring>::KaratsubaThreshold = 32;
+
+	template <class Ring>
+	size_t Multiplier<Ring>::ToomThreshold = 256;
+
+	template <class Ring>
+	size_t Multiplier<Ring>::NttThreshold = 64;
+
+	template <class Ring>
+	size_t Multiplier<Ring>::MultiModularThreshold = 2048;
+
+	template <class Ring>
+	MULTIPLICATION_ALGORITHM Multiplier<Ring>::Algorithm = MULTIPLICATION_ALGORITHM::AUTO;
+
+	/////////////// IMPLEMENTATION
+
+	template <class Ring>
+	Multiplier<Ring>::Multiplier(const Ring& ring) : ring_(ring)
+	{
+	}
+
+	template <class Ring>
+	bool Multiplier<Ring>::toom_supported() const
+	{
+		// interpolation divides by 2 and 3
+		auto m = ring_.modulus();
+		return m % 2 != 0 && m % 3 != 0;
+	}
+
+	template <class Ring>
+	typename Multiplier<Ring>::T Multiplier<Ring>::convolution(const T* a, size_t na, const T* b, size_t nb, size_t k) const
+	{
+		const uint64_t limit = ring_.accumulate_limit();
+		size_t lo = k >= nb ? k - nb + 1 : 0, hi = std::min(k, na - 1);
+		T sum = T();
+		if (limit == 0)
+		{
+			for (size_t i = lo; i <= hi; ++i)
+				sum = ring_.add(sum, ring_.mul(a[i], b[k - i]));
+			return sum;
+		}
+		uint64_t acc = 0, count = 0;
+		for (size_t i = lo; i <= hi; ++i)
+		{
+			if (count++ == limit)
+			{
+				sum = ring_.add(sum, ring_.reduce(acc));
+				acc = 0;
+				count = 1;
+			}
+			acc += ring_.product(a[i], b[k - i]);
+		}
+		return ring_.add(sum, ring_.reduce(acc));
+	}
+
+	template <class Ring>
+	void Multiplier<Ring>::schoolbook(const T* a, size_t na, const T* b, size_t nb, T* res) const
+	{
+		if (a == b && na == nb)
+		{
+			schoolbook_square(a, na, res);
+			return;
+		}
+		for (size_t k = 0, sz = na + nb - 1; k < sz; ++k)
+			res[k] = convolution(a, na, b, nb, k);
+	}
+
+	template <class Ring>
+	void Multiplier<Ring>::schoolbook_square(const T* a, size_t n, T* res) const
+	{
+		const uint64_t limit = ring_.accumulate_limit();
+		for (size_t k = 0, sz = 2 * n - 1; k < sz; ++k)
+		{
+			// pairs i < j with i + j = k
+			size_t lo = k >= n ? k - n + 1 : 0;
+			T sum = T();
+			if (limit == 0)
+			{
+				for (size_t i = lo; i < k - i; ++i)
+					sum = ring_.add(sum, ring_.mul(a[i], a[k - i]));
+			}
+			else
+			{
+				uint64_t acc = 0, count = 0;
+				for (size_t i = lo; i < k - i; ++i)
+				{
+					if (count++ == limit)
+					{
+						sum = ring_.add(sum, ring_.reduce(acc));
+						acc = 0;
+						count = 1;
+					}
+					acc += ring_.product(a[i], a[k - i]);
+				}
+				sum = ring_.add(sum, ring_.reduce(acc));
+			}
+			sum = ring_.add(sum, sum);
+			if (k % 2 == 0)
+				sum = ring_.add(sum, ring_.mul(a[k / 2], a[k / 2]));
+			res[k] = sum;
+		}
+	}
+
+	template <class Ring>
+	size_t Multiplier<Ring>::scratch_size(size_t n) const
+	{
+		if (n < KaratsubaThreshold || n < 2 || Algorithm == MULTIPLICATION_ALGORITHM::SCHOOLBOOK)
+			return 0;
+		if (n >= 3 && toom_supported() && ((Algorithm == MULTIPLICATION_ALGORITHM::AUTO && n >= ToomThreshold) || Algorithm == MULTIPLICATION_ALGORITHM::TOOM3))
+		{
+			size_t k = (n + 2) / 3;
+			return 18 * k + scratch_size(k);
+		}
+		size_t m = n / 2, h = n - m;
+		return std::max(scratch_size(m), 4 * h + scratch_size(h));
+	}
+
+	template <class Ring>
+	void Multiplier<Ring>::balanced(const T* a, const T* b, size_t n, T* res, T* scratch) const
+	{
+		if (n < KaratsubaThreshold || n < 2 || Algorithm == MULTIPLICATION_ALGORITHM::SCHOOLBOOK)
+			schoolbook(a, n, b, n, res);
+		else if (n >= 3 && toom_supported() && ((Algorithm == MULTIPLICATION_ALGORITHM::AUTO && n >= ToomThreshold) || Algorithm == MULTIPLICATION_ALGORITHM::TOOM3))
+			toom3(a, b, n, res, scratch);
+		else
+			karatsuba(a, b, n, res, scratch);
+	}
+
+	template <class Ring>
+	void Multiplier<Ring>::karatsuba(const T* a, const T* b, size_t n, T* res, T* scratch) const
+	{
+		// a = a0 + a1 * x^m, where a0 has m coefficients and a1 has h >= m
+		size_t m = n / 2, h = n - m;
+		const T *a0 = a, *a1 = a + m, *b0 = b, *b1 = b + m;
+
+		// z0 = a0 * b0 and z2 = a1 * b1 go straight to their places
+		balanced(a0, b0, m, res, scratch);
+		res[2 * m - 1] = T();
+		balanced(a1, b1, h, res + 2 * m, scratch);
+
+		// z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+		T *sa = scratch, *sb = scratch + h, *z1 = scratch + 2 * h;
+		for (size_t i = 0; i < h; ++i)
+			sa[i] = i < m ? ring_.add(a0[i], a1[i]) : a1[i];
+		if (a == b)
+			sb = sa;
+		else
+		{
+			for (size_t i = 0; i < h; ++i)
+				sb[i] = i < m ? ring_.add(b0[i], b1[i]) : b1[i];
+		}
+		balanced(sa, sb, h, z1, scratch + 4 * h);
+		for (size_t i = 0; i < 2 * m - 1; ++i)
+			z1[i] = ring_.sub(z1[i], res[i]);
+		for (size_t i = 0; i < 2 * h - 1; ++i)
+			z1[i] = ring_.sub(z1[i], res[2 * m + i]);
+		for (size_t i = 0; i < 2 * h - 1; ++i)
+			res[m + i] = ring_.add(res[m + i], z1[i]);
+	}
+
+	template <class Ring>
+	void Multiplier<Ring>::toom3(const T* a, const T* b, size_t n, T* res, T* scratch) const
+	{
+		// a = a0 + a1 * y + a2 * y^2, y = x^k, a2 has n - 2k <= k coefficients
+		size_t k = (n + 2) / 3, r = n - 2 * k, len = 2 * k - 1;
+		const T two = ring_.from(2), inv2 = ring_.inverse(two), inv3 = ring_.inverse(ring_.from(3));
+
+		// evaluation in 1, -1, -2, infinity for both operands (value in 0 is a0 itself)
+		T *ea = scratch, *eb = scratch + 4 * k, *prod = scratch + 8 * k, *rest = scratch + 18 * k;
+		auto evaluate = [&](const T* p, T* e)
+		{
+			T *e1 = e, *em1 = e + k, *em2 = e + 2 * k, *einf = e + 3 * k;
+			for (size_t i = 0; i < k; ++i)
+			{
+				T p0 = p[i], p1 = p[k + i], p2 = i < r ? p[2 * k + i] : T();
+				T even = ring_.add(p0, p2);
+				e1[i] = ring_.add(even, p1);
+				em1[i] = ring_.sub(even, p1);
+				// a0 - 2a1 + 4a2 = 2 * (a(-1) + a2) - a0
+				em2[i] = ring_.sub(ring_.mul(two, ring_.add(em1[i], p2)), p0);
+				einf[i] = p2;
+			}
+		};
+		evaluate(a, ea);
+		if (a == b)
+			eb = ea;
+		else
+			evaluate(b, eb);
+
+		T *r0 = prod, *r1 = prod + 2 * k, *rm1 = prod + 4 * k, *rm2 = prod + 6 * k, *rinf = prod + 8 * k;
+		balanced(a, b, k, r0, rest);
+		balanced(ea, eb, k, r1, rest);
+		balanced(ea + k, eb + k, k, rm1, rest);
+		balanced(ea + 2 * k, eb + 2 * k, k, rm2, rest);
+		balanced(ea + 3 * k, eb + 3 * k, k, rinf, rest);
+
+		// interpolation (Bodrato's sequence)
+		for (size_t i = 0; i < len; ++i)
+		{
+			T v3 = ring_.mul(ring_.sub(rm2[i], r1[i]), inv3);
+			T v1 = ring_.mul(ring_.sub(r1[i], rm1[i]), inv2);
+			T v2 = ring_.sub(rm1[i], r0[i]);
+			v3 = ring_.add(ring_.mul(ring_.sub(v2, v3), inv2), ring_.mul(two, rinf[i]));
+			v2 = ring_.sub(ring_.add(v2, v1), rinf[i]);
+			v1 = ring_.sub(v1, v3);
+			r1[i] = v1;
+			rm1[i] = v2;
+			rm2[i] = v3;
+		}
+
+		// res = r0 + v1 y + v2 y^2 + v3 y^3 + rinf y^4, coefficients past 2n - 1 are zero
+		size_t total = 2 * n - 1;
+		std::fill(res, res + total, T());
+		const T* parts[] = { r0, r1, rm1, rm2, rinf };
+		for (size_t part = 0; part < 5; ++part)
+		{
+			for (size_t i = 0, offset = part * k; i < len && offset + i < total; ++i)
+				res[offset + i] = ring_.add(res[offset + i], parts[part][i]);
+		}
+	}
+
+	template <class Ring>
+	void Multiplier<Ring>::operator()(const T* a, size_t na, const T* b, size_t nb, T* res) const
+	{
+		if (na < nb)
+		{
+			std::swap(a, b);
+			std::swap(na, nb);
+		}
+		size_t threshold = ring_.direct_transform(na + nb - 1) ? NttThreshold : MultiModularThreshold;
+		bool transform = Algorithm == MULTIPLICATION_ALGORITHM::NTT || (Algorithm == MULTIPLICATION_ALGORITHM::AUTO && nb >= threshold);
+		if (transform && ring_.transform_multiply(a, na, b, nb, res))
+			return;
+		if (nb < KaratsubaThreshold || Algorithm == MULTIPLICATION_ALGORITHM::SCHOOLBOOK)
+		{
+			schoolbook(a, na, b, nb, res);
+			return;
+		}
+
+		static thread_local std::vector<T> scratch;
+		size_t needed = 3 * nb + scratch_size(nb);
+		if (scratch.size() < needed)
+			scratch.resize(needed);
+
+		// a is cut into pieces of nb coefficients, each piece is a balanced product.
+		// The last piece is padded with zeros up to nb.
+		std::fill(res, res + na + nb - 1, T());
+		T *chunk = scratch.data(), *padded = chunk + 2 * nb, *rest = padded + nb;
+		for (size_t offset = 0; offset < na; offset += nb)
+		{
+			size_t len = std::min(nb, na - offset);
+			const T* piece = a + offset;
+			if (len < nb)
+			{
+				std::copy(piece, piece + len, padded);
+				std::fill(padded + len, padded + nb, T());
+				piece = padded;
+			}
+			balanced(piece, b, nb, chunk, rest);
+			for (size_t i = 0, sz = len + nb - 1; i < sz; ++i)
+				res[offset + i] = ring_.add(res[offset + i], chunk[i]);
+		}
+	}
+
+	template <class Ring>
+	void Multiplier<Ring>::accumulate(const T* a, size_t na, const T* b, size_t nb, T* acc, bool subtract) const
+	{
+		if (std::min(na, nb) < KaratsubaThreshold || Algorithm == MULTIPLICATION_ALGORITHM::SCHOOLBOOK)
+		{
+			for (size_t k = 0, sz = na + nb - 1; k < sz; ++k)
+			{
+				T c = convolution(a, na, b, nb, k);
+				acc[k] = subtract ? ring_.sub(acc[k], c) : ring_.add(acc[k], c);
+			}
+			return;
+		}
+		static thread_local std::vector<T> product;
+		if (product.size() < na + nb - 1)
+			product.resize(na + nb - 1);
+		(*this)(a, na, b, nb, product.data());
+		for (size_t k = 0, sz = na + nb - 1; k < sz; ++k)
+			acc[k] = subtract ? ring_.sub(acc[k], product[k]) : ring_.add(acc[k], product[k]);
+	}
+}
@@ -0,0 +1,247 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace Algebra
+{
+	// Number-theoretic transform over Z/P, where P is a prime of form 2^k * c + 1 (998244353 = 2^23 * 119 + 1).
+	// Transform length is a power of two dividing P - 1. Twiddle factors are computed once per P
+	// and shared between threads; tables only grow when a longer transform is requested.
+	template <size_t P>
+	class NumberTheoreticTransform
+	{
+		// roots[len + j] = w^j, where w is a primitive 2*len-th root of unity (len is a power of two)
+		struct Twiddles
+		{
+			std::vector<uint32_t> roots;
+			std::vector<uint32_t> inverse_roots;
+		};
+
+		static uint32_t		add				(uint32_t a, uint32_t b)	{ uint32_t s = a + b; return s >= P ? s - P : s; }
+		static uint32_t		sub				(uint32_t a, uint32_t b)	{ return a >= b ? a - b : a + uint32_t(P) - b; }
+		static uint32_t		mul				(uint32_t a, uint32_t b)	{ return uint32_t(uint64_t(a) * b % P); }
+		static uint32_t		power			(uint64_t a, uint64_t e);
+
+		static bool			IsPrime			();
+		static uint32_t		PrimitiveRoot	();
+		static std::shared_ptr<const Twiddles> GetTwiddles(size_t n);
+
+	public:
+		// Longest supported transform, 0 if P is not a prime below 2^31
+		static size_t		MaxLength		();
+		// Can a product with result_length coefficients be computed by transform
+		static bool			Supported		(size_t result_length);
+
+		// In-place transform of a power-of-two sized array. Result is left in bit-reversed order.
+		static void			Forward			(std::vector<uint32_t>& a);
+		// Takes bit-reversed input of Forward back to coefficients (including division by length)
+		static void			Inverse			(std::vector<uint32_t>& a);
+
+		// res[0 .. na + nb - 1) = a * b mod P, coefficients must be reduced
+		static void			Multiply		(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* res);
+	};
+
+	/////////////// IMPLEMENTATION
+
+	template <size_t P>
+	uint32_t NumberTheoreticTransform<P>::power(uint64_t a, uint64_t e)
+	{
+		uint64_t res = 1;
+		a %= P;
+		while (e)
+		{
+			if (e & 1)
+				res = res * a % P;
+			a = a * a % P;
+			e >>= 1;
+		}
+		return uint32_t(res);
+	}
+
+	template <size_t P>
+	bool NumberTheoreticTransform<P>::IsPrime()
+	{
+		static const bool prime = []()
+		{
+			if (P < 3 || P >= (size_t(1) << 31) || P % 2 == 0)
+				return false;
+			for (size_t d = 3; d * d <= P; d += 2)
+			{
+				if (P % d == 0)
+					return false;
+			}
+			return true;
+		}();
+		return prime;
+	}
+
+	template <size_t P>
+	uint32_t NumberTheoreticTransform<P>::PrimitiveRoot()
+	{
+		static const uint32_t root = []()
+		{
+			// g is primitive iff g^((P-1)/q) != 1 for every prime q | P - 1
+			std::vector<size_t> factors;
+			size_t rest = P - 1;
+			for (size_t d = 2; d * d <= rest; ++d)
+			{
+				if (rest % d == 0)
+				{
+					factors.push_back(d);
+					while (rest % d == 0)
+						rest /= d;
+				}
+			}
+			if (rest > 1)
+				factors.push_back(rest);
+			for (uint32_t g = 2;; ++g)
+			{
+				bool primitive = true;
+				for (auto q : factors)
+				{
+					if (power(g, (P - 1) / q) == 1)
+					{
+						primitive = false;
+						break;
+					}
+				}
+				if (primitive)
+					return g;
+			}
+		}();
+		return root;
+	}
+
+	template <size_t P>
+	std::shared_ptr<const typename NumberTheoreticTransform<P>::Twiddles> NumberTheoreticTransform<P>::GetTwiddles(size_t n)
+	{
+		static std::mutex lock;
+		static std::shared_ptr<const Twiddles> cached;
+
+		std::lock_guard<std::mutex> guard(lock);
+		if (cached && cached->roots.size() >= n)
+			return cached;
+
+		// readers keep using the old tables, new ones replace them atomically under the lock
+		auto grown = cached ? std::make_shared<Twiddles>(*cached) : std::make_shared<Twiddles>();
+		if (grown->roots.empty())
+		{
+			grown->roots.push_back(0);
+			grown->inverse_roots.push_back(0);
+		}
+		for (size_t len = grown->roots.size(); len < n; len <<= 1)
+		{
+			uint32_t w = power(PrimitiveRoot(), (P - 1) / (2 * len)), iw = power(w, P - 2);
+			uint32_t wj = 1, iwj = 1;
+			for (size_t j = 0; j < len; ++j)
+			{
+				grown->roots.push_back(wj);
+				grown->inverse_roots.push_back(iwj);
+				wj = mul(wj, w);
+				iwj = mul(iwj, iw);
+			}
+		}
+		cached = grown;
+		return cached;
+	}
+
+	template <size_t P>
+	size_t NumberTheoreticTransform<P>::MaxLength()
+	{
+		if (!IsPrime())
+			return 0;
+		size_t len = 1;
+		while ((P - 1) % (len * 2) == 0)
+			len *= 2;
+		return len;
+	}
+
+	template <size_t P>
+	bool NumberTheoreticTransform<P>::Supported(size_t result_length)
+	{
+		size_t max_length = MaxLength();
+		return max_length >= 2 && result_length <= max_length;
+	}
+
+	template <size_t P>
+	void NumberTheoreticTransform<P>::Forward(std::vector<uint32_t>& a)
+	{
+		size_t n = a.size();
+		auto twiddles = GetTwiddles(n);
+		const uint32_t* roots = twiddles->roots.data();
+		// decimation in frequency: natural order in, bit-reversed out
+		for (size_t len = n / 2; len >= 1; len >>= 1)
+		{
+			const uint32_t* w = roots + len;
+			for (size_t i = 0; i < n; i += 2 * len)
+			{
+				for (size_t j = 0; j < len; ++j)
+				{
+					uint32_t u = a[i + j], v = a[i + j + len];
+					a[i + j] = add(u, v);
+					a[i + j + len] = mul(sub(u, v), w[j]);
+				}
+			}
+		}
+	}
+
+	template <size_t P>
+	void NumberTheoreticTransform<P>::Inverse(std::vector<uint32_t>& a)
+	{
+		size_t n = a.size();
+		auto twiddles = GetTwiddles(n);
+		const uint32_t* inverse_roots = twiddles->inverse_roots.data();
+		// decimation in time: bit-reversed in, natural order out
+		for (size_t len = 1; len < n; len <<= 1)
+		{
+			const uint32_t* w = inverse_roots + len;
+			for (size_t i = 0; i < n; i += 2 * len)
+			{
+				for (size_t j = 0; j < len; ++j)
+				{
+					uint32_t u = a[i + j], v = mul(a[i + j + len], w[j]);
+					a[i + j] = add(u, v);
+					a[i + j + len] = sub(u, v);
+				}
+			}
+		}
+		uint32_t inverse_n = power(n, P - 2);
+		for (auto& coefficient : a)
+			coefficient = mul(coefficient, inverse_n);
+	}
+
+	template <size_t P>
+	void NumberTheoreticTransform<P>::Multiply(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* res)
+	{
+		size_t result_length = na + nb - 1, n = 1;
+		while (n < result_length)
+			n <<= 1;
+		if (n > MaxLength())
+			throw std::runtime_error("Product is too long for number-theoretic transform modulo this prime");
+
+		std::vector<uint32_t> fa(a, a + na);
+		fa.resize(n);
+		Forward(fa);
+		if (a == b && na == nb)
+		{
+			// squaring needs only one forward transform
+			for (auto& value : fa)
+				value = mul(value, value);
+		}
+		else
+		{
+			std::vector<uint32_t> fb(b, b + nb);
+			fb.resize(n);
+			Forward(fb);
+			for (size_t i = 0; i < n; ++i)
+				fa[i] = mul(fa[i], fb[i]);
+		}
+		Inverse(fa);
+		std::copy(fa.begin(), fa.begin() + result_length, res);
+	}
+}
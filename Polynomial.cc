@@ -1 +1,615 @@
-#include "Polynomial.h"
\ No newline at end of file
+#include "Polynomial.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ALGEBRA_X86
+#define ALGEBRA_TARGET_PCLMUL
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ALGEBRA_X86
+#define ALGEBRA_TARGET_PCLMUL __attribute__((target("pclmul,sse2")))
+#endif
+
+namespace Algebra
+{
+	/////////////// CONSTANT DEFINTION
+
+	OUTPUT_MODE Polynomial<2>::OutputMode = OUTPUT_MODE::MINIMAL;
+
+	DIVISION_CORRUPTION_POLICY Polynomial<2>::DivisionPolicy = DIVISION_CORRUPTION_POLICY::THROW;
+
+	const Polynomial<2> Polynomial<2>::One	=	{ 1 };
+	const Polynomial<2> Polynomial<2>::Zero	=	{ 0 };
+	const Polynomial<2> Polynomial<2>::X	=	{ 0, 1 };
+
+	/////////////// CARRY-LESS MULTIPLICATION KERNELS
+
+	// 64x64 -> 128 carry-less product, 4 bits of b at a time
+	static void clmul_portable(uint64_t a, uint64_t b, uint64_t& lo, uint64_t& hi)
+	{
+		// a * k for k < 16 needs 67 bits: low word + 3 overflow bits
+		uint64_t tlo[16], thi[16];
+		tlo[0] = thi[0] = 0;
+		for (size_t k = 1; k < 16; ++k)
+		{
+			size_t top = 0;
+			while ((k >> (top + 1)) != 0)
+				++top;
+			// k = 2^top + rest
+			tlo[k] = tlo[k ^ (1u << top)] ^ (a << top);
+			thi[k] = thi[k ^ (1u << top)] ^ (top ? a >> (64 - top) : 0);
+		}
+		lo = hi = 0;
+		for (size_t i = 0; i < 64; i += 4)
+		{
+			size_t w = (b >> i) & 15;
+			lo ^= tlo[w] << i;
+			hi ^= thi[w] << i;
+			if (i)
+				hi ^= tlo[w] >> (64 - i);
+		}
+	}
+
+	static void multiply_words_portable(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* res)
+	{
+		for (size_t i = 0; i < na; ++i)
+		{
+			if (!a[i])
+				continue;
+			for (size_t j = 0; j < nb; ++j)
+			{
+				uint64_t lo, hi;
+				clmul_portable(a[i], b[j], lo, hi);
+				res[i + j] ^= lo;
+				res[i + j + 1] ^= hi;
+			}
+		}
+	}
+
+#ifdef ALGEBRA_X86
+	ALGEBRA_TARGET_PCLMUL
+	static void multiply_words_pclmul(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* res)
+	{
+		alignas(16) uint64_t out[2];
+		for (size_t i = 0; i < na; ++i)
+		{
+			if (!a[i])
+				continue;
+			__m128i va = _mm_set_epi64x(0, static_cast<long long>(a[i]));
+			for (size_t j = 0; j < nb; ++j)
+			{
+				__m128i vb = _mm_set_epi64x(0, static_cast<long long>(b[j]));
+				_mm_store_si128(reinterpret_cast<__m128i*>(out), _mm_clmulepi64_si128(va, vb, 0x00));
+				res[i + j] ^= out[0];
+				res[i + j + 1] ^= out[1];
+			}
+		}
+	}
+
+	static bool cpu_has_pclmul()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] >> 1) & 1;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("pclmul");
+#endif
+	}
+#endif
+
+	typedef void(*multiply_words_kernel)(const uint64_t*, size_t, const uint64_t*, size_t, uint64_t*);
+
+	static multiply_words_kernel select_multiply_words()
+	{
+#ifdef ALGEBRA_X86
+		if (cpu_has_pclmul())
+			return multiply_words_pclmul;
+#endif
+		return multiply_words_portable;
+	}
+
+	// bit i of half goes to bit 2i: (sum a_i x^i)^2 = sum a_i x^2i in characteristic 2
+	static uint64_t spread_bits(uint32_t half)
+	{
+		uint64_t x = half;
+		x = (x | x << 16) & 0x0000FFFF0000FFFFull;
+		x = (x | x << 8) & 0x00FF00FF00FF00FFull;
+		x = (x | x << 4) & 0x0F0F0F0F0F0F0F0Full;
+		x = (x | x << 2) & 0x3333333333333333ull;
+		x = (x | x << 1) & 0x5555555555555555ull;
+		return x;
+	}
+
+	/////////////// IMPLEMENTATION
+
+	size_t Polynomial<2>::WordsFor(size_t bits)
+	{
+		return (bits + WordBits - 1) / WordBits;
+	}
+
+	size_t Polynomial<2>::HighestBit(uint64_t word)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanReverse64(&index, word);
+		return index;
+#elif defined(__GNUC__) || defined(__clang__)
+		return WordBits - 1 - __builtin_clzll(word);
+#else
+		size_t index = 0;
+		while (word >>= 1)
+			++index;
+		return index;
+#endif
+	}
+
+	void Polynomial<2>::MultiplyWords(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* res)
+	{
+		static const multiply_words_kernel kernel = select_multiply_words();
+		kernel(a, na, b, nb, res);
+	}
+
+	void Polynomial<2>::XorShifted(uint64_t* dst, size_t dst_words, const uint64_t* src, size_t src_words, size_t shift)
+	{
+		size_t word_shift = shift / WordBits, bit_shift = shift % WordBits;
+		for (size_t i = 0; i < src_words && i + word_shift < dst_words; ++i)
+		{
+			dst[i + word_shift] ^= src[i] << bit_shift;
+			if (bit_shift && i + word_shift + 1 < dst_words)
+				dst[i + word_shift + 1] ^= src[i] >> (WordBits - bit_shift);
+		}
+	}
+
+	void Polynomial<2>::resize(size_t new_length)
+	{
+		words.resize(WordsFor(new_length));
+		// keep bits above length cleared
+		if (new_length % WordBits)
+			words.back() &= (uint64_t(1) << (new_length % WordBits)) - 1;
+		length = new_length;
+	}
+
+	void Polynomial<2>::normalize()
+	{
+		size_t i = words.size();
+		while (i > 0 && !words[i - 1])
+			--i;
+		resize(i ? (i - 1) * WordBits + HighestBit(words[i - 1]) + 1 : 1);
+	}
+
+	Polynomial<2>::Polynomial(size_t length) : words(WordsFor(length)), length(length)
+	{
+	}
+
+	Polynomial<2>::Polynomial(const std::initializer_list<int>& l) : Polynomial(std::vector<int>(l))
+	{
+	}
+
+	Polynomial<2>::Polynomial(const std::vector<int>& powers) : Polynomial(powers.size())
+	{
+		assign(powers);
+	}
+
+	size_t Polynomial<2>::size() const
+	{
+		return length;
+	}
+
+	size_t Polynomial<2>::operator[](size_t idx) const
+	{
+		if (idx >= length)
+			return 0;
+		return (words[idx / WordBits] >> (idx % WordBits)) & 1;
+	}
+
+	void Polynomial<2>::assign(const std::vector<int>& p)
+	{
+		words.assign(WordsFor(p.size()), 0);
+		length = p.size();
+		for (size_t i = 0, sz = p.size(); i < sz; ++i)
+		{
+			if (p[i] & 1)
+				words[i / WordBits] |= uint64_t(1) << (i % WordBits);
+		}
+		normalize();
+	}
+
+	void Polynomial<2>::set(size_t idx, long long value)
+	{
+		if (idx >= length)
+			resize(idx + 1);
+		uint64_t bit = uint64_t(1) << (idx % WordBits);
+		if (value & 1)
+			words[idx / WordBits] |= bit;
+		else
+			words[idx / WordBits] &= ~bit;
+		if (idx + 1 == length)
+			normalize();
+	}
+
+	size_t Polynomial<2>::eval(int x_value) const
+	{
+		if (!(x_value & 1))
+			return (*this)[0];
+		// p(1) is the parity of the number of non-zero coefficients
+		uint64_t parity = 0;
+		for (auto word : words)
+			parity ^= word;
+		for (size_t half = WordBits / 2; half; half >>= 1)
+			parity ^= parity >> half;
+		return parity & 1;
+	}
+
+	std::vector<size_t> Polynomial<2>::eval_many(const std::vector<size_t>& points) const
+	{
+		std::vector<size_t> res(points.size());
+		for (size_t i = 0; i < points.size(); ++i)
+			res[i] = eval(int(points[i] & 1));
+		return res;
+	}
+
+	size_t Polynomial<2>::deg() const
+	{
+		return length - 1;
+	}
+
+	Polynomial<2> Polynomial<2>::derivative() const
+	{
+		// (x^i)' = i * x^(i-1), so only odd powers survive and land on even positions
+		Polynomial res = this->shift_back(1);
+		for (auto& word : res.words)
+			word &= 0x5555555555555555ull;
+		res.normalize();
+		return res;
+	}
+
+	Polynomial<2> Polynomial<2>::shift(size_t shift) const
+	{
+		if (shift == 0 || *this == Zero)
+			return *this;
+		Polynomial res(length + shift);
+		XorShifted(res.words.data(), res.words.size(), words.data(), words.size(), shift);
+		return res;
+	}
+
+	Polynomial<2> Polynomial<2>::shift_back(size_t shift) const
+	{
+		if (shift == 0)
+			return *this;
+		auto dg = this->deg();
+		if (shift > dg)
+			return Zero;
+		Polynomial res(dg + 1 - shift);
+		size_t word_shift = shift / WordBits, bit_shift = shift % WordBits;
+		for (size_t i = 0, sz = res.words.size(); i < sz; ++i)
+		{
+			uint64_t word = words[i + word_shift] >> bit_shift;
+			if (bit_shift && i + word_shift + 1 < words.size())
+				word |= words[i + word_shift + 1] << (WordBits - bit_shift);
+			res.words[i] = word;
+		}
+		res.resize(res.length);
+		return res;
+	}
+
+	Polynomial<2>& Polynomial<2>::operator+=(const Polynomial& p)
+	{
+		if (p.length > length)
+			resize(p.length);
+		for (size_t i = 0, sz = p.words.size(); i < sz; ++i)
+			words[i] ^= p.words[i];
+		normalize();
+		return *this;
+	}
+
+	Polynomial<2> Polynomial<2>::operator+(const Polynomial& p) const &
+	{
+		auto res = *this;
+		return res += p;
+	}
+
+	Polynomial<2> Polynomial<2>::operator+(const Polynomial& p) &&
+	{
+		return std::move(*this += p);
+	}
+
+	Polynomial<2>& Polynomial<2>::operator-=(const Polynomial& p)
+	{
+		return *this += p;
+	}
+
+	Polynomial<2> Polynomial<2>::operator-(const Polynomial& p) const &
+	{
+		auto res = *this;
+		return res -= p;
+	}
+
+	Polynomial<2> Polynomial<2>::operator-(const Polynomial& p) &&
+	{
+		return std::move(*this -= p);
+	}
+
+	Polynomial<2>& Polynomial<2>::operator*=(const Polynomial& p)
+	{
+		if (*this == Polynomial::One)
+			return *this = p;
+		if (p == Polynomial::One)
+			return *this;
+		if (p == Polynomial::Zero)
+			return *this = Polynomial::Zero;
+
+		size_t na = words.size(), nb = p.words.size();
+		// no zero divisors in GF(2), the degrees add up
+		Polynomial res(length + p.deg());
+		wvec product(na + nb);
+		MultiplyWords(words.data(), na, p.words.data(), nb, product.data());
+		product.resize(res.words.size());
+		res.words.swap(product);
+		return *this = std::move(res);
+	}
+
+	Polynomial<2>& Polynomial<2>::operator*=(Polynomial&& p)
+	{
+		if (*this == Polynomial::One)
+			return *this = std::move(p);
+		return *this *= static_cast<const Polynomial&>(p);
+	}
+
+	Polynomial<2> Polynomial<2>::operator*(const Polynomial& p) const &
+	{
+		Polynomial res = *this;
+		return res *= p;
+	}
+
+	Polynomial<2> Polynomial<2>::operator*(const Polynomial& p) &&
+	{
+		return std::move(*this *= p);
+	}
+
+	Polynomial<2>& Polynomial<2>::operator*=(long long number)
+	{
+		if (!(number & 1))
+			return *this = Polynomial::Zero;
+		return *this;
+	}
+
+	Polynomial<2> Polynomial<2>::operator*(long long number) const &
+	{
+		if (!(number & 1))
+			return{ 0 };
+		return *this;
+	}
+
+	Polynomial<2> Polynomial<2>::operator*(long long number) &&
+	{
+		return std::move(*this *= number);
+	}
+
+	Polynomial<2>& Polynomial<2>::addmul(const Polynomial& a, const Polynomial& b)
+	{
+		if (&a == this || &b == this)
+			return *this += a * b;
+		size_t na = a.words.size(), nb = b.words.size();
+		if (words.size() < na + nb)
+			words.resize(na + nb);
+		MultiplyWords(a.words.data(), na, b.words.data(), nb, words.data());
+		normalize();
+		return *this;
+	}
+
+	Polynomial<2>& Polynomial<2>::submul(const Polynomial& a, const Polynomial& b)
+	{
+		return addmul(a, b);
+	}
+
+	Polynomial<2> Polynomial<2>::square() const
+	{
+		size_t n = this->deg() + 1;
+		Polynomial res(2 * n - 1);
+		for (size_t i = 0, sz = WordsFor(n); i < sz; ++i)
+		{
+			res.words[2 * i] = spread_bits(uint32_t(words[i]));
+			if (2 * i + 1 < res.words.size())
+				res.words[2 * i + 1] = spread_bits(uint32_t(words[i] >> 32));
+		}
+		return res;
+	}
+
+	Polynomial<2> Polynomial<2>::frobenius(size_t k) const
+	{
+		Polynomial res = *this;
+		for (size_t i = 0; i < k; ++i)
+			res = res.square();
+		return res;
+	}
+
+	Polynomial<2> Polynomial<2>::negate() const &
+	{
+		return *this;
+	}
+
+	Polynomial<2> Polynomial<2>::negate() &&
+	{
+		return std::move(*this);
+	}
+
+	std::pair<Polynomial<2>, Polynomial<2>> Polynomial<2>::divide(const Polynomial& p) const
+	{
+		if (p == Polynomial::Zero)
+			throw std::runtime_error("Cannot divide by zero");
+
+		size_t dt = this->deg(), dp = p.deg();
+		if (dp > dt)
+			return std::make_pair(Polynomial::Zero, *this);
+		Polynomial quotient(dt - dp + 1);
+		Polynomial remainder = *this;
+
+		// leading coefficient is always 1, so every step is a plain XOR of the shifted divisor
+		size_t divisor_words = WordsFor(dp + 1);
+		for (size_t shift_value = dt - dp; shift_value != size_t(-1); --shift_value)
+		{
+			if (remainder[shift_value + dp])
+			{
+				quotient.words[shift_value / WordBits] |= uint64_t(1) << (shift_value % WordBits);
+				XorShifted(remainder.words.data(), remainder.words.size(), p.words.data(), divisor_words, shift_value);
+			}
+		}
+		remainder.normalize();
+		return std::make_pair(std::move(quotient), std::move(remainder));
+	}
+
+	Polynomial<2> Polynomial<2>::operator%(const Polynomial& p) const
+	{
+		return this->divide(p).second;
+	}
+
+	Polynomial<2>& Polynomial<2>::operator%=(const Polynomial& p)
+	{
+		*this = *this % p;
+		return *this;
+	}
+
+	Polynomial<2> Polynomial<2>::operator/(const Polynomial& p) const
+	{
+		return this->divide(p).first;
+	}
+
+	Polynomial<2>& Polynomial<2>::operator/=(const Polynomial& p)
+	{
+		*this = *this / p;
+		return *this;
+	}
+
+	void Polynomial<2>::swap(Polynomial& p) noexcept
+	{
+		words.swap(p.words);
+		std::swap(length, p.length);
+	}
+
+	Polynomial<2> Polynomial<2>::pow(size_t power) const
+	{
+		return window_power(*this, power, One,
+			[](const Polynomial& a, const Polynomial& b) { return a * b; },
+			[](const Polynomial& a) { return a.square(); });
+	}
+
+	bool Polynomial<2>::operator==(const Polynomial& p) const
+	{
+		// both are trimmed, so equal polynomials have equal sizes
+		return words == p.words;
+	}
+
+	size_t Polynomial<2>::hash() const
+	{
+		uint64_t res = 14695981039346656037ull;
+		for (auto w : words)
+			res = (res ^ w) * 1099511628211ull;
+		return size_t(res);
+	}
+
+	bool Polynomial<2>::operator!=(const Polynomial& p) const
+	{
+		return !((*this) == p);
+	}
+
+	bool Polynomial<2>::operator<(const Polynomial& p) const
+	{
+		size_t dt = this->deg(), dp = p.deg();
+		if (dt < dp)
+			return true;
+		if (dt > dp)
+			return false;
+		return (*this)[dt] < p[dp];
+	}
+
+	bool Polynomial<2>::operator>(const Polynomial& p) const
+	{
+		return !((*this) < p);
+	}
+
+	Polynomial<2> Polynomial<2>::Gcd(const Polynomial& p1, const Polynomial& p2)
+	{
+		const Polynomial *minp = &p1, *maxp = &p2;
+		if (p1 > p2)
+			std::swap(minp, maxp);
+		if (*minp == Polynomial::Zero)
+			return *maxp;
+		if (*minp == Polynomial::One)
+			return Polynomial::One;
+		if (*minp == *maxp)
+			return *minp;
+		Polynomial a = *maxp, b = *minp;
+		while (b != Polynomial::Zero)
+		{
+			auto r = a.divide(b).second;
+			a = b;
+			b = r;
+		}
+
+		return a;
+	}
+
+	Polynomial<2> Polynomial<2>::ExpandedGcd(Polynomial a, Polynomial b, Polynomial mod)
+	{
+		a %= mod;
+		b %= mod;
+		if (a == Polynomial::One)
+			return b;
+		auto g = Polynomial::Gcd(a, mod);
+		if (g != Polynomial::One)
+		{
+			if (b % g != Polynomial::Zero)
+				throw std::runtime_error("Cannot find a solution");
+			a /= g;
+			b /= g;
+			mod /= g;
+		}
+		std::array<std::array<Polynomial, 4>, 2> matrix = { { { Zero, mod, One, Zero },{ Zero, a, Zero, One } } };
+		while (matrix[1][1] != One)
+		{
+			auto split = matrix[0][1].divide(matrix[1][1]);
+			matrix[0][0] = std::move(split.first); // q_i = r_i-2 / r_i-1
+			matrix[0][1] = std::move(split.second); // r_i = r_i-2 mod r_i-1
+			matrix[0][2].submul(matrix[0][0], matrix[1][2]); // x_i = x_i-2 - q_i-1*x_i-1
+			matrix[0][3].submul(matrix[0][0], matrix[1][3]); // y_i = y_i-2 - q_i-1*y_i-1
+
+			std::swap(matrix[0], matrix[1]); // shift up
+		}
+		return matrix[1][3] * b % mod;
+	}
+
+	Polynomial<2> Polynomial<2>::PowMod(const Polynomial& base, size_t exponent, const Polynomial& modulus)
+	{
+		return window_power(base.divide(modulus).second, exponent, One.divide(modulus).second,
+			[&modulus](const Polynomial& a, const Polynomial& b) { return (a * b).divide(modulus).second; },
+			[&modulus](const Polynomial& a) { return a.square().divide(modulus).second; });
+	}
+
+	Polynomial<2> Polynomial<2>::MulMod(const Polynomial& a, const Polynomial& b, const Polynomial& modulus)
+	{
+		return PolynomialModulus<2>(modulus).mulmod(a, b);
+	}
+
+	Polynomial<2> Polynomial<2>::FrobeniusMod(const Polynomial& base, size_t n, const Polynomial& modulus)
+	{
+		Polynomial power = base.divide(modulus).second;
+		// b^(2^(i+1)) = (b^(2^i))^2
+		for (size_t i = 0; i < n; ++i)
+			power = power.square().divide(modulus).second;
+		return power;
+	}
+
+	Polynomial<2> Polynomial<2>::SpecialPolyMod(size_t n, const Polynomial& modpoly)
+	{
+		return (FrobeniusMod(X, n, modpoly) - X) % modpoly;
+	}
+
+	Polynomial<2> Polynomial<2>::Interpolate(const std::vector<size_t>& points, const std::vector<size_t>& values)
+	{
+		if (points.empty())
+			return Zero;
+		return SubproductTree<2>(points).interpolate(values);
+	}
+}
@@ -4,7 +4,15 @@
 #include <numeric>
 #include <functional>
 #include <array>
+#include <limits>
+#include <stdexcept>
 #include "Algebra.h"
+#include "ModInt.h"
+#include "Multiplication.h"
+#include "Division.h"
+#include "Gcd.h"
+#include "CoefficientKernels.h"
+#include "Exponentiation.h"
 
 
 namespace Algebra
@@ -22,21 +30,39 @@ namespace Algebra
 		CLOSEST_REMAINDER
 	};
 
+	template <size_t Zp>
+	class PolynomialModulus;
+
+	template <size_t Zp>
+	class SubproductTree;
+
 	template <size_t Zp>
 	// FROM LEFT TO RIGHT: 0 0 1 - x^2
+	// Coefficients are kept trimmed: size() == deg() + 1, zero is { 0 }
 	class Polynomial {\
 		static_assert(Zp > 1, "Zp cannot be less than 2");
 
+		friend class PolynomialModulus<Zp>;
+
 		typedef std::vector<int> vec;
+		typedef ModInt<Zp> coefficient;
+		typedef std::vector<coefficient> cvec;
+
+		cvec powers;
 
-		vec powers;
+		static cvec		Coefficients	(const vec& powers);
+		// drops high zero coefficients, every mutation ends with it
+		void			normalize		();
+		Polynomial&		accumulate		(const Polynomial& a, const Polynomial& b, bool subtract);
 	protected:
-		// used inside pow() - just dumb * cycle
-		Polynomial		rpow			(size_t num)				const;
-		// use this to construct without normalization (modulus check)
-		Polynomial						(const vec& powers, bool normalization);
+		// use this to construct from already reduced coefficients
+		explicit Polynomial				(const cvec& powers);
+		explicit Polynomial				(cvec&& powers);
 
 	public:
+		// Zp is a prime small enough that f(x)^Zp = f(x^Zp) (a coefficient spread) is cheaper than Zp-th power by squarings;
+		// pow, PowMod and FrobeniusMod then go through frobenius() and exponents in base Zp
+		static const bool							SpreadPowers = Zp <= 5 && is_prime(Zp);
 		static OUTPUT_MODE							OutputMode;
 		static DIVISION_CORRUPTION_POLICY			DivisionPolicy;
 		static const Polynomial						One;
@@ -47,18 +73,30 @@ namespace Algebra
 		Polynomial						(const std::initializer_list<int>& l);
 		Polynomial						(const vec& powers);
 
+		Polynomial						(const Polynomial& p) = default;
+		// moves only hand over the coefficient buffer
+		Polynomial						(Polynomial&& p) noexcept = default;
+		Polynomial&		operator =		(const Polynomial& p) = default;
+		Polynomial&		operator =		(Polynomial&& p) noexcept = default;
+
 		//// CONTROL FUNCTIONS AND OPERATORS
 
+		// deg() + 1
 		size_t			size()										const;
 
-		int				operator[]		(size_t idx)				const;
+		// 0 above the degree
+		size_t			operator[]		(size_t idx)				const;
 		
 
 		void			assign			(const std::vector<int>& p);
-		void			set				(size_t idx, int value);
+		void			set				(size_t idx, long long value);
 
+		// Horner's scheme: O(n)
 		size_t			eval			(int x_value)				const;
+		// values at every point by a SubproductTree, O(M(n) log n) for n points; build the tree once to reuse it
+		std::vector<size_t>	eval_many	(const std::vector<size_t>& points) const;
 
+		// O(1)
 		size_t			deg				()							const;
 
 		//// ALGEBRAIC FUNCTIONS AND OPERATORS
@@ -70,31 +108,48 @@ namespace Algebra
 		Polynomial		shift(size_t shift)				const;
 		/////// ARITHMETIC
 
-		//
+		// In place, allocates only when p is longer
 		Polynomial&		operator +=		(const Polynomial& p);
-		// O(n)
-		Polynomial		operator +		(const Polynomial& p)		const;
+		// O(n); the rvalue versions reuse the left operand's buffer
+		Polynomial		operator +		(const Polynomial& p)		const &;
+		Polynomial		operator +		(const Polynomial& p)		&&;
 
 		Polynomial&		operator -=		(const Polynomial& p);
-		Polynomial		operator -		(const Polynomial& p)		const;
+		Polynomial		operator -		(const Polynomial& p)		const &;
+		Polynomial		operator -		(const Polynomial& p)		&&;
 
-		// O(n^2)
+		// schoolbook, Karatsuba or Toom-3 by operand size, see Multiplier
 		Polynomial&		operator *=		(const Polynomial& p);
-		// O(n^2)
-		Polynomial		operator *		(const Polynomial& p)		const;
+		Polynomial&		operator *=		(Polynomial&& p);
+		Polynomial		operator *		(const Polynomial& p)		const &;
+		Polynomial		operator *		(const Polynomial& p)		&&;
 		// Just constant multiplication: O(n)
-		Polynomial		operator *		(int number)				const;
+		Polynomial&		operator *=		(long long number);
+		Polynomial		operator *		(long long number)			const &;
+		Polynomial		operator *		(long long number)			&&;
+		// this += a * b and this -= a * b: the product is accumulated into this buffer, see Multiplier::accumulate
+		Polynomial&		addmul			(const Polynomial& a, const Polynomial& b);
+		Polynomial&		submul			(const Polynomial& a, const Polynomial& b);
+		// this * this with the squaring kernels of Multiplier (half the products of schoolbook, one transform)
+		Polynomial		square			()							const;
+		// this(x^(Zp^k)): O(n) coefficient spread, equal to this^(Zp^k) when Zp is a prime
+		Polynomial		frobenius		(size_t k)					const;
 		// *-1
-		Polynomial		negate()									const;
+		Polynomial		negate()									const &;
+		Polynomial		negate()									&&;
 
 
 		std::pair<Polynomial, Polynomial> divide(const Polynomial& p)const;
-		Polynomial		operator %		(const Polynomial& p);
+		Polynomial		operator %		(const Polynomial& p)		const;
+		// the remainder is computed in this polynomial's buffer
 		Polynomial&		operator %=		(const Polynomial& p);
-		Polynomial		operator /		(const Polynomial& p);
+		Polynomial		operator /		(const Polynomial& p)		const;
 		Polynomial&		operator /=		(const Polynomial& p);
 
-		// O(d*n^2)
+		void			swap			(Polynomial& p)				noexcept;
+
+		// Sliding window: log2(power) squarings and about log2(power) / w other multiplications.
+		// With SpreadPowers power is written in base Zp, every digit costs one multiplication and a frobenius()
 		Polynomial		pow				(size_t power)				const;
 		
 
@@ -106,6 +161,9 @@ namespace Algebra
 		bool			operator <		(const Polynomial& p)		const;
 		bool			operator >		(const Polynomial& p)		const;
 
+		// FNV-1a over the coefficients, std::hash goes through it
+		size_t			hash			()							const;
+
 
 
 		//// OUTPUT
@@ -114,7 +172,7 @@ namespace Algebra
 			const size_t last_index = p.size() - 1;
 
 			bool printed = false;
-			for (size_t i = last_index; i != -1; --i) {
+			for (size_t i = last_index; i != size_t(-1); --i) {
 				if (p[i] != 0 || OutputMode == OUTPUT_MODE::CANONICAL)
 				{
 					// insert operator only AFTER the first (thus, we are sure, that this operator is needed)
@@ -139,12 +197,28 @@ namespace Algebra
 			return s;
 		}
 
+		// Half-GCD above Euclid::HalfGcdThreshold coefficients, classical remainder sequence below
+		// (and when a remainder has a zero divisor as leading coefficient, see DivisionPolicy)
 		static Polynomial	Gcd			(const Polynomial& p1, const Polynomial& p2);
+		// Solves a * y = b mod mod with the Bezout cofactor of a from Euclid, throws if there is no solution
 		static Polynomial	ExpandedGcd	(Polynomial a, Polynomial b, Polynomial mod);
 
+		// base^exponent mod modulus: sliding window with reduction after every product, O(deg modulus) memory.
+		// With SpreadPowers Horner's scheme in base Zp: a reduced frobenius() and one multiplication per digit.
+		// Use PolynomialModulus directly to keep its precomputation between calls
+		static Polynomial	PowMod		(const Polynomial& base, size_t exponent, const Polynomial& modulus);
+		// a * b mod modulus, the product is reduced in its own buffer
+		static Polynomial	MulMod		(const Polynomial& a, const Polynomial& b, const Polynomial& modulus);
+		// base^(q^n) mod modulus by n Frobenius steps (raising to the power q = Zp, a reduced spread with SpreadPowers)
+		static Polynomial	FrobeniusMod(const Polynomial& base, size_t n, const Polynomial& modulus);
+
 		// Poly : x^(q^n) - x mod f(x)
-		// TODO: Make more sophisticated implmenetation
+		// Computed by FrobeniusMod, never builds x^(q^n) itself
 		static Polynomial SpecialPolyMod(size_t n, const Polynomial& modpoly);
+
+		// The polynomial of degree below points.size() with values[i] at points[i] by a SubproductTree: O(M(n) log n).
+		// Points have to be distinct
+		static Polynomial	Interpolate	(const std::vector<size_t>& points, const std::vector<size_t>& values);
 	};
 
 	/////////////// CONSTANT DEFINTION 
@@ -167,25 +241,35 @@ namespace Algebra
 
 
 	template <size_t Zp>
-	Polynomial<Zp> Polynomial<Zp>::rpow(size_t num) const
+	typename Polynomial<Zp>::cvec Polynomial<Zp>::Coefficients(const vec& powers)
 	{
-		if (num == 0)
-			return One;
-		if (num == 1)
-			return *this;
-
-		Polynomial res = One;
-		while (num--)
-		{
-			res *= *this;
-		}
+		cvec res(powers.size());
+		for (size_t i = 0, sz = powers.size(); i < sz; ++i)
+			res[i] = coefficient(powers[i]);
 		return res;
 	}
 
 	template <size_t Zp>
-	Polynomial<Zp>::Polynomial(const vec& powers, bool normalization) :
-		powers(normalization ? normalize(powers, Zp) : powers)
+	void Polynomial<Zp>::normalize()
 	{
+		size_t sz = powers.size();
+		while (sz > 1 && !powers[sz - 1])
+			--sz;
+		powers.resize(std::max<size_t>(sz, 1));
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp>::Polynomial(const cvec& powers) :
+		powers(powers)
+	{
+		normalize();
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp>::Polynomial(cvec&& powers) :
+		powers(std::move(powers))
+	{
+		normalize();
 	}
 
 
@@ -193,14 +277,16 @@ namespace Algebra
 
 
 	template <size_t Zp>
-	Polynomial<Zp>::Polynomial(const std::initializer_list<int>& l) : powers(normalize(l, Zp))
+	Polynomial<Zp>::Polynomial(const std::initializer_list<int>& l) : powers(Coefficients(l))
 	{
+		normalize();
 	}
 
 	template <size_t Zp>
 	Polynomial<Zp>::Polynomial(const vec& powers) :
-		powers(normalize(powers, Zp))
+		powers(Coefficients(powers))
 	{
+		normalize();
 	}
 
 
@@ -208,9 +294,9 @@ namespace Algebra
 
 
 	template <size_t Zp>
-	int Polynomial<Zp>::operator[](size_t idx) const
+	size_t Polynomial<Zp>::operator[](size_t idx) const
 	{
-		return powers[idx];
+		return idx < powers.size() ? size_t(powers[idx].value()) : 0;
 	}
 
 
@@ -221,61 +307,86 @@ namespace Algebra
 	}
 
 	template <size_t Zp>
-	Polynomial<Zp> Polynomial<Zp>::negate() const
+	void Polynomial<Zp>::swap(Polynomial& p) noexcept
+	{
+		powers.swap(p.powers);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::negate() const &
+	{
+		Polynomial res = *this;
+		return std::move(res).negate();
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::negate() &&
 	{
-		return *this * -1;
+		CoefficientLoops<Zp>::Negate(powers.data(), powers.size());
+		return std::move(*this);
 	}
 
 	template <size_t Zp>
 	Polynomial<Zp>& Polynomial<Zp>::operator-=(const Polynomial& p)
 	{
-		return *this += p.negate();
+		if (powers.size() < p.size())
+			powers.resize(p.size());
+		// p may be this polynomial itself, its size does not change then
+		CoefficientLoops<Zp>::Sub(powers.data(), p.powers.data(), p.size());
+		normalize();
+		return *this;
 	}
 
 	template <size_t Zp>
-	Polynomial<Zp> Polynomial<Zp>::operator-(const Polynomial& p) const
+	Polynomial<Zp> Polynomial<Zp>::operator-(const Polynomial& p) const &
 	{
 		Polynomial res = *this;
-		return res -= p;
+		return std::move(res -= p);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::operator-(const Polynomial& p) &&
+	{
+		return std::move(*this -= p);
 	}
 
 	template <size_t Zp>
 	Polynomial<Zp>& Polynomial<Zp>::operator+=(const Polynomial& p)
 	{
-		size_t maxs = std::max(p.size(), this->size());
-		const vec &minv = maxs == p.size() ? powers : p.powers, &maxv = maxs == p.size() ? p.powers : powers;
-		size_t mins = minv.size();
-		vec resv(maxs);
-		for (size_t i = 0; i < maxs; ++i)
-		{
-			if (i < mins)
-				resv[i] = mod((minv[i] + maxv[i]), Zp);
-			else
-				resv[i] = maxv[i];
-		}
-		this->powers = resv;
+		if (powers.size() < p.size())
+			powers.resize(p.size());
+		CoefficientLoops<Zp>::Add(powers.data(), p.powers.data(), p.size());
+		normalize();
 		return *this;
 	}
 
 	template <size_t Zp>
-	Polynomial<Zp> Polynomial<Zp>::operator+(const Polynomial& p) const
+	Polynomial<Zp> Polynomial<Zp>::operator+(const Polynomial& p) const &
 	{
 		auto res = *this;
-		return res += p;
+		return std::move(res += p);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::operator+(const Polynomial& p) &&
+	{
+		return std::move(*this += p);
 	}
 
 	template <size_t Zp>
 	bool Polynomial<Zp>::operator==(const Polynomial& p) const
 	{
-		size_t dt = this->deg(), dp = p.deg();
-		if (dt != dp)
-			return false;
-		for (size_t i = dt; i != -1; --i)
-		{
-			if ((*this)[i] != p[i])
-				return false;
-		}
-		return true;
+		// both are trimmed, so equal polynomials have equal sizes
+		return powers == p.powers;
+	}
+
+	template <size_t Zp>
+	size_t Polynomial<Zp>::hash() const
+	{
+		uint64_t res = 14695981039346656037ull;
+		for (const auto& c : powers)
+			res = (res ^ c.value()) * 1099511628211ull;
+		return size_t(res);
 	}
 
 	template <size_t Zp>
@@ -292,61 +403,134 @@ namespace Algebra
 		if (p == Polynomial::One)
 			return *this;
 
-		Polynomial res = { 0 };
-		for (size_t idx = 0, s = p.size(); idx < s; ++idx)
-		{
-			if (p[idx])
-			{
-				res += (*this * p[idx]).shift(idx);
-			}
-		}
-		*this = res;
+		if (p == Polynomial::Zero)
+			return *this = Polynomial::Zero;
+
+		size_t na = this->size(), nb = p.size();
+		cvec res(na + nb - 1);
+		Multiplier<ModularRing<Zp>>()(powers.data(), na, p.powers.data(), nb, res.data());
+		powers.swap(res);
+		// leading coefficients can be zero divisors
+		normalize();
+		return *this;
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp>& Polynomial<Zp>::operator*=(Polynomial&& p)
+	{
+		if (*this == Polynomial::One)
+			return *this = std::move(p);
+		return *this *= static_cast<const Polynomial&>(p);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp>& Polynomial<Zp>::operator*=(long long number)
+	{
+		coefficient c(number);
+		if (!c)
+			return *this = Polynomial::Zero;
+		if (c == coefficient(1))
+			return *this;
+		CoefficientLoops<Zp>::Scale(powers.data(), powers.size(), c);
+		normalize();
 		return *this;
 	}
 
 	template <size_t Zp>
-	Polynomial<Zp> Polynomial<Zp>::operator*(int number) const
+	Polynomial<Zp> Polynomial<Zp>::operator*(long long number) const &
 	{
-		number = mod(number, Zp);
-		if (number == 0)
+		if (!coefficient(number))
 			return{ 0 };
 		Polynomial res = *this;
-		if (number == 1)
-			return res;
-		for (auto& p : res.powers)
-		{
-			p = mod((p * number), Zp);
-		}
-		return res;
+		return std::move(res *= number);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::operator*(long long number) &&
+	{
+		return std::move(*this *= number);
 	}
 
 	template <size_t Zp>
-	Polynomial<Zp> Polynomial<Zp>::operator*(const Polynomial& p) const
+	Polynomial<Zp> Polynomial<Zp>::operator*(const Polynomial& p) const &
 	{
 		Polynomial res = *this;
-		return res *= p;
+		return std::move(res *= p);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::operator*(const Polynomial& p) &&
+	{
+		return std::move(*this *= p);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp>& Polynomial<Zp>::addmul(const Polynomial& a, const Polynomial& b)
+	{
+		return accumulate(a, b, false);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp>& Polynomial<Zp>::submul(const Polynomial& a, const Polynomial& b)
+	{
+		return accumulate(a, b, true);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp>& Polynomial<Zp>::accumulate(const Polynomial& a, const Polynomial& b, bool subtract)
+	{
+		// the accumulator must not overlap the operands
+		if (&a == this || &b == this)
+			return subtract ? *this -= a * b : *this += a * b;
+		size_t n = a.size() + b.size() - 1;
+		if (powers.size() < n)
+			powers.resize(n);
+		Multiplier<ModularRing<Zp>>().accumulate(a.powers.data(), a.size(), b.powers.data(), b.size(), powers.data(), subtract);
+		normalize();
+		return *this;
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::square() const
+	{
+		size_t n = this->size();
+		cvec res(2 * n - 1);
+		Multiplier<ModularRing<Zp>>()(powers.data(), n, powers.data(), n, res.data());
+		return Polynomial(std::move(res));
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::frobenius(size_t k) const
+	{
+		const size_t max = std::numeric_limits<size_t>::max();
+		size_t step = 1, dg = this->deg();
+		for (size_t i = 0; i < k; ++i)
+		{
+			if (step > max / Zp)
+				throw std::runtime_error("Degree of the result does not fit into size_t");
+			step *= Zp;
+		}
+		if (dg && step > (max - 1) / dg)
+			throw std::runtime_error("Degree of the result does not fit into size_t");
+		cvec res(dg * step + 1);
+		for (size_t i = 0; i <= dg; ++i)
+			res[i * step] = powers[i];
+		return Polynomial(std::move(res));
 	}
 
 	template <size_t Zp>
 	Polynomial<Zp> Polynomial<Zp>::pow(size_t power) const
 	{
-		if (!power)
-			return{ 1 };
-		if (power == 1)
-			return *this;
-		Polynomial res = One, prev = *this;
-		size_t prev_power = 1;
-		size_t rpower = 1;
-		while (rpower != 0)
+		if (!SpreadPowers || power < Zp)
+			return window_power(*this, power, One,
+				[](const Polynomial& a, const Polynomial& b) { return a * b; },
+				[](const Polynomial& a) { return a.square(); });
+		// this^(d0 + d1 Zp + d2 Zp^2 + ...) = this^d0 * (this^d1)(x^Zp) * (this^d2)(x^(Zp^2)) * ...
+		Polynomial res = One;
+		for (size_t k = 0; power; power /= Zp, ++k)
 		{
-			if (power & rpower)
-			{
-				// calculate how many pows to prev
-				prev = prev.rpow(rpower / prev_power);
-				res *= prev;
-				prev_power = rpower;
-			}
-			rpower <<= 1;
+			if (power % Zp)
+				res *= pow(power % Zp).frobenius(k);
 		}
 		return res;
 	}
@@ -354,14 +538,14 @@ namespace Algebra
 	template <size_t Zp>
 	Polynomial<Zp> Polynomial<Zp>::shift(size_t shift) const
 	{
-		if (shift == 0)
+		if (shift == 0 || *this == Zero)
 			return *this;
-		vec resv(this->size() + shift);
+		cvec resv(this->size() + shift);
 		for (size_t i = 0, s = this->size(); i < s; ++i)
 		{
-			resv[shift + i] = (*this)[i];
+			resv[shift + i] = powers[i];
 		}
-		return Polynomial(resv, false);
+		return Polynomial(std::move(resv));
 	}
 
 	template <size_t Zp>
@@ -372,60 +556,69 @@ namespace Algebra
 		auto dg = this->deg();
 		if (shift > dg)
 			return Zero;
-		vec resv(dg + 1 - shift);
+		cvec resv(dg + 1 - shift);
 		for (size_t i = 0, sz = dg - shift; i<=sz; ++i)
 		{
-			resv[i] = (*this)[i + shift];
+			resv[i] = powers[i + shift];
 		}
-		return Polynomial(resv, false);
+		return Polynomial(std::move(resv));
 	}
 
 
 	template <size_t Zp>
 	void Polynomial<Zp>::assign(const std::vector<int>& p)
 	{
-		powers = normalize(p, Zp);
+		powers = Coefficients(p);
+		normalize();
 	}
 
 	template <size_t Zp>
-	void Polynomial<Zp>::set(size_t idx, int value)
+	void Polynomial<Zp>::set(size_t idx, long long value)
 	{
-		powers[idx] = mod(value, Zp);
+		coefficient c(value);
+		if (idx >= powers.size())
+		{
+			if (!c)
+				return;
+			powers.resize(idx + 1);
+		}
+		powers[idx] = c;
+		if (idx + 1 == powers.size())
+			normalize();
 	}
 
 	template <size_t Zp>
 	size_t Polynomial<Zp>::eval(int x_value) const
 	{
-		x_value = mod(x_value, Zp);
-		size_t res = 0;
-		for (size_t i = 0, sz = powers.size(); i < sz; ++i)
-		{
-			auto p = powers[i];
-			if (p)
-				res = mod(res + powmod(x_value, i, Zp) * p, Zp);
-		}
-		return res;
+		coefficient x(x_value), res;
+		for (size_t i = powers.size(); i-- > 0;)
+			res = res * x + powers[i];
+		return size_t(res.value());
+	}
+
+	template <size_t Zp>
+	std::vector<size_t> Polynomial<Zp>::eval_many(const std::vector<size_t>& points) const
+	{
+		if (points.empty())
+			return {};
+		return SubproductTree<Zp>(points).evaluate(*this);
 	}
 
 	template <size_t Zp>
 	size_t Polynomial<Zp>::deg() const
 	{
-		for (size_t i = powers.size() - 1; i != -1; --i)
-		{
-			if (powers[i])
-				return i;
-		}
-		return 0;
+		return powers.size() - 1;
 	}
 
 	template <size_t Zp>
 	Polynomial<Zp> Polynomial<Zp>::derivative() const
 	{
 		Polynomial<Zp> res = this->shift_back(1);
-		for (size_t i = res.deg(); i != -1; --i)
+		for (size_t i = res.deg(); i != size_t(-1); --i)
 		{
-			res.set(i, res[i] * (i + 1));
+			res.powers[i] *= coefficient(i + 1);
 		}
+		res.normalize();
 		return res;
 	}
 
@@ -440,17 +633,24 @@ namespace Algebra
 		size_t dt = this->deg(), dp = p.deg();
 		if (dp > dt)
 			return std::make_pair(Polynomial::Zero, *this);
-		Polynomial quotient = std::vector<int>(dt - dp + 1);
+		cvec quotient(dt - dp + 1);
 		Polynomial remainder = *this;
 
 		auto leading_coefficient = p[dp];
+		if (gcd(leading_coefficient, Zp) == 1)
+		{
+			Divider<ModularRing<Zp>>()(remainder.powers.data(), dt + 1, p.powers.data(), dp + 1, quotient.data());
+			remainder.normalize();
+			return std::make_pair(Polynomial(std::move(quotient)), std::move(remainder));
+		}
+		// leading coefficient is a zero divisor: solve a * x = b for every coefficient, see DivisionPolicy
 		bool end = false;
 
 		while (dt >= dp && remainder != Polynomial::Zero && !end)
 		{
 			size_t shift_value = dt - dp; // x^3 / x - shift value will be 2
 			size_t coefficient = expanded_gcd(leading_coefficient, remainder[dt], Zp);
-			if (coefficient == -1)
+			if (coefficient == size_t(-1))
 			{
 				if (DivisionPolicy == DIVISION_CORRUPTION_POLICY::THROW)
 					throw std::runtime_error("Cannot find the coefficients wich will suffice the equation");
@@ -460,28 +660,45 @@ namespace Algebra
 					coefficient = 1;
 				end = true;
 			}
-			quotient.set(shift_value, coefficient);
-			remainder -= (p * coefficient).shift(shift_value);
+			ModInt<Zp> c(coefficient);
+			quotient[shift_value] = c;
+			// remainder -= coefficient * p * x^shift_value, without temporaries
+			for (size_t i = 0; i <= dp; ++i)
+				remainder.powers[shift_value + i] -= c * p.powers[i];
+			remainder.normalize();
 			dt = remainder.deg();
 		}
-		return std::make_pair(quotient, remainder);
+		return std::make_pair(Polynomial(std::move(quotient)), std::move(remainder));
 	}
 
 	template <size_t Zp>
-	Polynomial<Zp> Polynomial<Zp>::operator%(const Polynomial& p)
+	Polynomial<Zp> Polynomial<Zp>::operator%(const Polynomial& p) const
 	{
-		return this->divide(p).second;
+		// one copy reduced in place, no quotient
+		Polynomial res = *this;
+		return std::move(res %= p);
 	}
 
 	template <size_t Zp>
 	Polynomial<Zp>& Polynomial<Zp>::operator%=(const Polynomial& p)
 	{
-		*this = *this % p;
-		return *this;
+		if (p == Polynomial::Zero)
+			throw std::runtime_error("Cannot divide by zero");
+		size_t dt = this->deg(), dp = p.deg();
+		if (dp > dt)
+			return *this;
+		if (this != &p && gcd(p[dp], Zp) == 1)
+		{
+			// the quotient is not needed
+			Divider<ModularRing<Zp>>()(powers.data(), dt + 1, p.powers.data(), dp + 1, nullptr);
+			normalize();
+			return *this;
+		}
+		return *this = this->divide(p).second;
 	}
 
 	template <size_t Zp>
-	Polynomial<Zp> Polynomial<Zp>::operator/(const Polynomial& p)
+	Polynomial<Zp> Polynomial<Zp>::operator/(const Polynomial& p) const
 	{
 		return this->divide(p).first;
 	}
@@ -489,8 +706,7 @@ namespace Algebra
 	template <size_t Zp>
 	Polynomial<Zp>& Polynomial<Zp>::operator/=(const Polynomial& p)
 	{
-		*this = *this / p;
-		return *this;
+		return *this = this->divide(p).first;
 	}
 
 	template <size_t Zp>
@@ -517,18 +733,20 @@ namespace Algebra
 		if (p1 > p2)
 			std::swap(minp, maxp);
 		if (*minp == Polynomial::Zero)
-			return p2;
+			return *maxp;
 		if (*minp == Polynomial::One)
 			return Polynomial::One;
 		if (*minp == *maxp)
 			return *minp;
+		cvec g;
+		if (Euclid<ModularRing<Zp>>()(maxp->powers.data(), maxp->size(), minp->powers.data(), minp->size(), g))
+			return Polynomial(std::move(g));
 		// Oh, well, let's copy
 		Polynomial a = *maxp, b = *minp;
 		while (b != Polynomial::Zero)
 		{
-			auto r = a.divide(b).second;
-			a = b;
-			b = r;
+			a %= b;
+			a.swap(b);
 		}
 
 		return a;
@@ -541,6 +759,18 @@ namespace Algebra
 		b %= mod;
 		if (a == Polynomial::One)
 			return b;
+		// y * a = r mod mod for the last remainder r, so y * (b / r) is a solution modulo mod / r
+		cvec r, y;
+		if (Euclid<ModularRing<Zp>>()(mod.powers.data(), mod.size(), a.powers.data(), a.size(), r, nullptr, &y))
+		{
+			Polynomial gp(std::move(r)), yp(y.empty() ? cvec(1) : std::move(y));
+			auto split = b.divide(gp);
+			if (split.second != Polynomial::Zero)
+				throw std::runtime_error("Cannot find a solution");
+			yp *= split.first;
+			return std::move(yp %= mod / gp);
+		}
+		// a remainder has a zero divisor as leading coefficient
 		auto g = Polynomial::Gcd(a, mod);
 		if (g != Polynomial::One)
 		{
@@ -556,28 +786,60 @@ namespace Algebra
 		std::array<std::array<Polynomial, 4>, 2> matrix = { { { Zero, mod, One, Zero },{ Zero, a, Zero, One } } };
 		while (matrix[1][1] != One)
 		{
-			Polynomial q_i = matrix[0][1] / matrix[1][1]; // q_i = r_i-2 / r_i-1
-			std::array<Polynomial, 4> temp = {
-				q_i,
-				matrix[0][1] % matrix[1][1], // r_i = r_i-2 mod r_i-1
-				matrix[0][2] - q_i * matrix[1][2], // x_i = x_i-2 - q_i-1*x_i-1
-				matrix[0][3] - q_i * matrix[1][3] // y_i = y_i-2 - q_i-1*y_i-1
-			};
-
-			matrix[0] = matrix[1]; // shift up
-			matrix[1] = temp;
+			auto split = matrix[0][1].divide(matrix[1][1]);
+			matrix[0][0] = std::move(split.first); // q_i = r_i-2 / r_i-1
+			matrix[0][1] = std::move(split.second); // r_i = r_i-2 mod r_i-1
+			matrix[0][2].submul(matrix[0][0], matrix[1][2]); // x_i = x_i-2 - q_i-1*x_i-1
+			matrix[0][3].submul(matrix[0][0], matrix[1][3]); // y_i = y_i-2 - q_i-1*y_i-1
+
+			std::swap(matrix[0], matrix[1]); // shift up
 		}
-		return matrix[1][3] * b % mod;
+		matrix[1][3] *= b;
+		return std::move(matrix[1][3] %= mod);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::PowMod(const Polynomial& base, size_t exponent, const Polynomial& modulus)
+	{
+		return PolynomialModulus<Zp>(modulus).powmod(base, exponent);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::MulMod(const Polynomial& a, const Polynomial& b, const Polynomial& modulus)
+	{
+		return PolynomialModulus<Zp>(modulus).mulmod(a, b);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::FrobeniusMod(const Polynomial& base, size_t n, const Polynomial& modulus)
+	{
+		return PolynomialModulus<Zp>(modulus).frobenius(base, n);
 	}
 
 	template <size_t Zp>
 	Polynomial<Zp> Polynomial<Zp>::SpecialPolyMod(size_t n, const Polynomial& modpoly)
 	{
-		size_t deg = ::pow(Zp, n);
-		std::vector<int> polynomial(deg + 1);
-		polynomial[deg] = 1;
-		polynomial[1] = -1;
-		return Polynomial(polynomial) % modpoly;
+		PolynomialModulus<Zp> modulus(modpoly);
+		return modulus.reduce(modulus.frobenius(X, n) - X);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> Polynomial<Zp>::Interpolate(const std::vector<size_t>& points, const std::vector<size_t>& values)
+	{
+		if (points.empty())
+			return Zero;
+		return SubproductTree<Zp>(points).interpolate(values);
 	}
 }
 
+// GF(2) specialization with bit-packed coefficients, it brings in PolynomialModulus.h and SubproductTree.h once Polynomial<2> is complete
+#include "BinaryPolynomial.h"
+
+namespace std
+{
+	template <size_t Zp>
+	struct hash<Algebra::Polynomial<Zp>>
+	{
+		size_t operator()(const Algebra::Polynomial<Zp>& p) const { return p.hash(); }
+	};
+}
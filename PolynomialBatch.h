@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include "ModInt.h"
+#include "CoefficientKernels.h"
+#include "Polynomial.h"
+
+
+namespace Algebra
+{
+	// Polynomials of degree at most degree() in structure-of-arrays layout: row i holds coefficient i of every polynomial,
+	// so the kernels run one polynomial per SIMD lane
+	template <size_t Zp>
+	class PolynomialBatch
+	{
+		typedef ModInt<Zp> coefficient;
+
+		size_t degree_, capacity_, size_ = 0;
+		// (degree_ + 1) rows of capacity_ coefficients
+		std::vector<coefficient> coefficients_;
+
+	public:
+		PolynomialBatch					(size_t degree, size_t capacity);
+
+		size_t			degree			()							const;
+		size_t			capacity		()							const;
+		size_t			size			()							const;
+
+		void			clear			();
+		// throws if the batch is full or p is of higher degree
+		void			push_back		(const Polynomial<Zp>& p);
+
+		// bit j % 64 of word j / 64 is set when polynomial j has a root in Z/Zp:
+		// every polynomial evaluated at every point by CoefficientKernels::HasRoot, O(Zp * degree() * size() / lanes)
+		std::vector<uint64_t>	roots	()							const;
+	};
+
+	/////////////// IMPLEMENTATION
+
+	template <size_t Zp>
+	PolynomialBatch<Zp>::PolynomialBatch(size_t degree, size_t capacity) :
+		degree_(degree), capacity_(capacity), coefficients_((degree + 1) * capacity)
+	{
+	}
+
+	template <size_t Zp>
+	size_t PolynomialBatch<Zp>::degree() const
+	{
+		return degree_;
+	}
+
+	template <size_t Zp>
+	size_t PolynomialBatch<Zp>::capacity() const
+	{
+		return capacity_;
+	}
+
+	template <size_t Zp>
+	size_t PolynomialBatch<Zp>::size() const
+	{
+		return size_;
+	}
+
+	template <size_t Zp>
+	void PolynomialBatch<Zp>::clear()
+	{
+		size_ = 0;
+	}
+
+	template <size_t Zp>
+	void PolynomialBatch<Zp>::push_back(const Polynomial<Zp>& p)
+	{
+		if (size_ == capacity_)
+			throw std::runtime_error("Polynomial batch is full");
+		if (p.deg() > degree_)
+			throw std::runtime_error("Polynomial degree exceeds the batch degree");
+		// every row is written, nothing is left over from before clear()
+		for (size_t i = 0; i <= degree_; ++i)
+			coefficients_[i * capacity_ + size_] = coefficient::Raw(static_cast<typename coefficient::storage_type>(p[i]));
+		++size_;
+	}
+
+	template <size_t Zp>
+	std::vector<uint64_t> PolynomialBatch<Zp>::roots() const
+	{
+		std::vector<uint64_t> res((size_ + 63) / 64);
+		if (size_)
+			CoefficientLoops<Zp>::HasRoot(coefficients_.data(), capacity_, degree_, size_, res.data());
+		return res;
+	}
+}
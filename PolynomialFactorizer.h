@@ -0,0 +1,308 @@
+#pragma once
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include "Algebra.h"
+#include "ModInt.h"
+#include "Polynomial.h"
+
+
+namespace Algebra
+{
+	enum class FACTORIZATION_ALGORITHM
+	{
+		// distinct-degree factorization, then equal-degree splitting with random elements
+		CANTOR_ZASSENHAUS,
+		// null space of Q - I, Q the matrix of the Frobenius map: O(n^3 + p n^2), for small p
+		BERLEKAMP
+	};
+
+	// Factorization into irreducible polynomials over GF(Zp), Zp prime:
+	// square-free factorization (Yun, with p-th roots where the derivative vanishes), then
+	// distinct-degree factorization and Cantor-Zassenhaus equal-degree splitting, or Berlekamp's matrix method.
+	// Polynomial in deg f and log Zp: every step is a Frobenius power, a product or a GCD modulo a factor of f
+	template <size_t Zp>
+	class PolynomialFactorizer
+	{
+		typedef Polynomial<Zp> poly;
+		typedef std::vector<std::pair<poly, size_t>> factorization;
+
+		std::mt19937_64 random_;
+
+		static poly		monic			(const poly& f);
+		static poly		exact_divide	(const poly& a, const poly& b);
+		// f(x) = g(x^Zp) gives g(x), which is f^(1/Zp) in characteristic Zp
+		static poly		root			(const poly& f);
+		// random polynomial of degree below n
+		poly			random			(size_t n);
+		// g with every irreducible factor of degree d, split in place into res
+		void			split			(const poly& g, size_t d, std::vector<poly>& res);
+
+	public:
+		static FACTORIZATION_ALGORITHM		Algorithm;
+
+		explicit PolynomialFactorizer	(uint64_t seed = 5489u);
+
+		// monic irreducible factors with multiplicities sorted by degree, the leading coefficient first unless it is 1;
+		// throws for zero
+		factorization		operator()		(const poly& f);
+
+		// f = prod s_i^i over pairwise coprime square-free monic s_i: (s_i, i) for s_i != 1
+		static factorization	SquareFree		(const poly& f);
+		// square-free monic f = prod g_d, g_d the product of the irreducible factors of degree d: (g_d, d) for g_d != 1
+		static factorization	DistinctDegree	(const poly& f);
+		// irreducible factors of g, all of degree d
+		std::vector<poly>	EqualDegree		(const poly& g, size_t d);
+		// irreducible factors of square-free monic f
+		static std::vector<poly>	Berlekamp		(const poly& f);
+	};
+
+	/////////////// CONSTANT DEFINTION
+
+	template <size_t Zp>
+	FACTORIZATION_ALGORITHM PolynomialFactorizer<Zp>::Algorithm = FACTORIZATION_ALGORITHM::CANTOR_ZASSENHAUS;
+
+	/////////////// IMPLEMENTATION
+
+	template <size_t Zp>
+	PolynomialFactorizer<Zp>::PolynomialFactorizer(uint64_t seed) : random_(seed)
+	{
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialFactorizer<Zp>::monic(const poly& f)
+	{
+		size_t lead = f[f.deg()];
+		return lead == 1 || lead == 0 ? f : f * static_cast<long long>(inverse_mod(lead, Zp));
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialFactorizer<Zp>::exact_divide(const poly& a, const poly& b)
+	{
+		return a.divide(b).first;
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialFactorizer<Zp>::root(const poly& f)
+	{
+		poly res = poly::Zero;
+		for (size_t i = f.deg() / Zp; i != size_t(-1); --i)
+			res.set(i, static_cast<long long>(f[i * Zp]));
+		return res;
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialFactorizer<Zp>::random(size_t n)
+	{
+		poly res = poly::Zero;
+		for (size_t i = n - 1; i != size_t(-1); --i)
+			res.set(i, static_cast<long long>(random_() % Zp));
+		return res;
+	}
+
+	template <size_t Zp>
+	typename PolynomialFactorizer<Zp>::factorization PolynomialFactorizer<Zp>::SquareFree(const poly& f)
+	{
+		factorization res;
+		poly derivative = f.derivative();
+		poly c = derivative == poly::Zero ? monic(f) : monic(poly::Gcd(f, derivative));
+		poly w = exact_divide(monic(f), c);
+		// Yun: w is the product of the factors of multiplicity at least i, c what is left of f
+		for (size_t i = 1; w.deg() > 0; ++i)
+		{
+			poly y = monic(poly::Gcd(w, c));
+			poly factor = exact_divide(w, y);
+			if (factor.deg() > 0)
+				res.push_back(std::make_pair(std::move(factor), i));
+			c = exact_divide(c, y);
+			w = std::move(y);
+		}
+		// the rest is a polynomial in x^Zp, its multiplicities are multiples of Zp
+		if (c.deg() > 0)
+		{
+			for (auto& part : SquareFree(root(c)))
+				res.push_back(std::make_pair(std::move(part.first), part.second * Zp));
+		}
+		return res;
+	}
+
+	template <size_t Zp>
+	typename PolynomialFactorizer<Zp>::factorization PolynomialFactorizer<Zp>::DistinctDegree(const poly& f)
+	{
+		factorization res;
+		poly rest = f;
+		PolynomialModulus<Zp> modulus(rest);
+		// h = x^(Zp^d) mod rest, gcd(rest, h - x) is the product of the factors whose degree divides d
+		poly h = modulus.reduce(poly::X);
+		for (size_t d = 1; 2 * d <= rest.deg(); ++d)
+		{
+			h = modulus.frobenius(h, 1);
+			poly g = monic(poly::Gcd(rest, h - poly::X));
+			if (g.deg() > 0)
+			{
+				rest = exact_divide(rest, g);
+				modulus = PolynomialModulus<Zp>(rest);
+				h = modulus.reduce(h);
+				res.push_back(std::make_pair(std::move(g), d));
+			}
+		}
+		// no factors up to half its degree
+		if (rest.deg() > 0)
+			res.push_back(std::make_pair(rest, rest.deg()));
+		return res;
+	}
+
+	template <size_t Zp>
+	void PolynomialFactorizer<Zp>::split(const poly& g, size_t d, std::vector<poly>& res)
+	{
+		if (g.deg() <= d)
+		{
+			res.push_back(g);
+			return;
+		}
+		PolynomialModulus<Zp> modulus(g);
+		while (true)
+		{
+			poly a = random(g.deg());
+			if (a.deg() == 0)
+				continue;
+			// trace a + a^2 + ... + a^(2^(d-1)) for Zp = 2, a^((Zp^d - 1) / 2) - 1 otherwise:
+			// both vanish on about half of the factors
+			poly t = a, conjugate = a;
+			for (size_t i = 1; i < d; ++i)
+			{
+				conjugate = modulus.frobenius(conjugate, 1);
+				t = Zp == 2 ? t + conjugate : modulus.mulmod(t, conjugate);
+			}
+			// (Zp^d - 1) / 2 = (Zp - 1) / 2 * (1 + Zp + ... + Zp^(d-1))
+			if (Zp != 2)
+				t = modulus.powmod(t, (Zp - 1) / 2) - poly::One;
+			poly c = monic(poly::Gcd(g, t));
+			if (c.deg() > 0 && c.deg() < g.deg())
+			{
+				split(c, d, res);
+				split(exact_divide(g, c), d, res);
+				return;
+			}
+		}
+	}
+
+	template <size_t Zp>
+	std::vector<Polynomial<Zp>> PolynomialFactorizer<Zp>::EqualDegree(const poly& g, size_t d)
+	{
+		std::vector<poly> res;
+		split(monic(g), d, res);
+		return res;
+	}
+
+	template <size_t Zp>
+	std::vector<Polynomial<Zp>> PolynomialFactorizer<Zp>::Berlekamp(const poly& f)
+	{
+		typedef ModInt<Zp> coefficient;
+		const size_t n = f.deg();
+		if (n <= 1)
+			return { f };
+		// column j of a is x^(j Zp) mod f - x^j: v with a v = 0 are the polynomials with v^Zp = v mod f
+		PolynomialModulus<Zp> modulus(f);
+		std::vector<std::vector<coefficient>> a(n, std::vector<coefficient>(n));
+		poly xp = modulus.powmod(poly::X, Zp), power = poly::One;
+		for (size_t j = 0; j < n; ++j)
+		{
+			for (size_t i = 0; i <= power.deg(); ++i)
+				a[i][j] = coefficient(static_cast<uint64_t>(power[i]));
+			a[j][j] -= coefficient(1);
+			power = modulus.mulmod(power, xp);
+		}
+		// reduced row echelon form, pivot_of[j] is the row of pivot column j
+		std::vector<size_t> pivot_of(n, size_t(-1));
+		for (size_t j = 0, row = 0; j < n && row < n; ++j)
+		{
+			size_t p = row;
+			while (p < n && !a[p][j])
+				++p;
+			if (p == n)
+				continue;
+			a[p].swap(a[row]);
+			coefficient inv = a[row][j].inverse();
+			for (auto& x : a[row])
+				x *= inv;
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (i == row || !a[i][j])
+					continue;
+				coefficient factor = a[i][j];
+				for (size_t k = j; k < n; ++k)
+					a[i][k] -= factor * a[row][k];
+			}
+			pivot_of[j] = row++;
+		}
+		// one basis vector per free column; the constant 1 is always among them
+		std::vector<poly> basis;
+		for (size_t j = 0; j < n; ++j)
+		{
+			if (pivot_of[j] != size_t(-1))
+				continue;
+			poly v = poly::Zero;
+			v.set(j, 1);
+			for (size_t k = 0; k < n; ++k)
+			{
+				if (pivot_of[k] != size_t(-1))
+					v.set(k, -static_cast<long long>(a[pivot_of[k]][j].value()));
+			}
+			if (v.deg() > 0)
+				basis.push_back(std::move(v));
+		}
+		// gcd(u, v - s) over s in GF(Zp) splits every factor u that v separates
+		const size_t count = basis.size() + 1;
+		std::vector<poly> res = { f };
+		for (size_t b = 0; b < basis.size() && res.size() < count; ++b)
+		{
+			for (size_t u = 0; u < res.size() && res.size() < count; ++u)
+			{
+				if (res[u].deg() <= 1)
+					continue;
+				for (size_t s = 0; s < Zp && res.size() < count; ++s)
+				{
+					poly g = monic(poly::Gcd(res[u], basis[b] - poly::One * static_cast<long long>(s)));
+					if (g.deg() > 0 && g.deg() < res[u].deg())
+					{
+						res.push_back(exact_divide(res[u], g));
+						res[u] = std::move(g);
+					}
+				}
+			}
+		}
+		return res;
+	}
+
+	template <size_t Zp>
+	typename PolynomialFactorizer<Zp>::factorization PolynomialFactorizer<Zp>::operator()(const poly& f)
+	{
+		if (f == poly::Zero)
+			throw std::runtime_error("Cannot factorize zero");
+		factorization res;
+		size_t lead = f[f.deg()];
+		if (lead != 1)
+			res.push_back(std::make_pair(poly::One * static_cast<long long>(lead), size_t(1)));
+		for (const auto& part : SquareFree(monic(f)))
+		{
+			std::vector<poly> irreducibles;
+			if (Algorithm == FACTORIZATION_ALGORITHM::BERLEKAMP)
+				irreducibles = Berlekamp(part.first);
+			else
+			{
+				for (const auto& group : DistinctDegree(part.first))
+					split(group.first, group.second, irreducibles);
+			}
+			for (auto& factor : irreducibles)
+				res.push_back(std::make_pair(std::move(factor), part.second));
+		}
+		std::sort(res.begin(), res.end(), [](const std::pair<poly, size_t>& x, const std::pair<poly, size_t>& y)
+		{
+			return x.first.deg() != y.first.deg() ? x.first.deg() < y.first.deg() : x.first < y.first;
+		});
+		return res;
+	}
+}
@@ -0,0 +1,361 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "Polynomial.h"
+
+
+namespace Algebra
+{
+	// Reduction modulo a fixed polynomial f of degree n.
+	// The inverse of the leading coefficient and the reciprocal rev(f)^-1 mod x^n are computed once (Newton's iteration),
+	// after that a product of two reduced polynomials is reduced by two multiplications (Barrett's method)
+	// instead of long division. Below the thresholds long division is faster and is used instead.
+	// A leading coefficient which is a zero divisor falls back to Polynomial::divide and its DivisionPolicy.
+	template <size_t Zp>
+	class PolynomialModulus
+	{
+		typedef ModInt<Zp> coefficient;
+		typedef std::vector<coefficient> cvec;
+		typedef Multiplier<ModularRing<Zp>> multiplier;
+
+		Polynomial<Zp> modulus_;
+		size_t deg_;
+		bool invertible_;
+		// rev(f)^-1 mod x^n (quotients of up to n terms), empty when reduction goes by long division
+		cvec reciprocal_;
+
+		// a = a mod f, a.size() becomes max(n, 1)
+		void			reduce_in_place	(cvec& a)					const;
+		// p^Zp mod f
+		Polynomial<Zp>	frobenius_step	(const Polynomial<Zp>& p)	const;
+
+	public:
+		// Moduli of at least that degree are reduced by Barrett's method
+		static size_t						BarrettThreshold;
+		// The same when Zp is NTT-friendly and the products go through the number-theoretic transform
+		static size_t						NttBarrettThreshold;
+
+		explicit PolynomialModulus		(const Polynomial<Zp>& modulus);
+
+		const Polynomial<Zp>&	modulus	()							const;
+		size_t			deg				()							const;
+
+		// p mod f for any p
+		Polynomial<Zp>	reduce			(const Polynomial<Zp>& p)	const;
+		// a * b mod f, mulmod(a, a) squares
+		Polynomial<Zp>	mulmod			(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const;
+		// base^exponent mod f, see Polynomial::PowMod
+		Polynomial<Zp>	powmod			(const Polynomial<Zp>& base, size_t exponent) const;
+		// base^(Zp^n) mod f, see Polynomial::FrobeniusMod
+		Polynomial<Zp>	frobenius		(const Polynomial<Zp>& base, size_t n) const;
+
+		// h^0, ..., h^m mod f: the table compose() takes for a fixed inner polynomial h
+		std::vector<Polynomial<Zp>>	power_table	(const Polynomial<Zp>& h, size_t m) const;
+		// g(h) mod f by Brent-Kung: g is cut into blocks of m coefficients, every block is a combination of the table
+		// (O(n) per coefficient of g, no multiplication) and the blocks are joined by Horner's scheme in h^m.
+		// deg g / m multiplications instead of deg g
+		Polynomial<Zp>	compose			(const Polynomial<Zp>& g, const std::vector<Polynomial<Zp>>& table) const;
+		// the same with a table of sqrt(deg g) powers built for this call
+		Polynomial<Zp>	compose			(const Polynomial<Zp>& g, const Polynomial<Zp>& h) const;
+	};
+
+	// GF(2): leading coefficient is always 1 and long division is a sequence of word XORs, there is nothing to precompute
+	template <>
+	class PolynomialModulus<2>
+	{
+		Polynomial<2> modulus_;
+
+	public:
+		explicit PolynomialModulus		(const Polynomial<2>& modulus);
+
+		const Polynomial<2>&	modulus	()							const;
+		size_t			deg				()							const;
+
+		Polynomial<2>	reduce			(const Polynomial<2>& p)	const;
+		Polynomial<2>	mulmod			(const Polynomial<2>& a, const Polynomial<2>& b) const;
+		Polynomial<2>	powmod			(const Polynomial<2>& base, size_t exponent) const;
+		Polynomial<2>	frobenius		(const Polynomial<2>& base, size_t n) const;
+
+		std::vector<Polynomial<2>>	power_table	(const Polynomial<2>& h, size_t m) const;
+		// a block of the table is a XOR of its entries
+		Polynomial<2>	compose			(const Polynomial<2>& g, const std::vector<Polynomial<2>>& table) const;
+		Polynomial<2>	compose			(const Polynomial<2>& g, const Polynomial<2>& h) const;
+	};
+
+	// Block size for Brent-Kung composition of a polynomial of degree n: ceil(sqrt(n + 1))
+	inline size_t composition_block(size_t n)
+	{
+		size_t m = 1;
+		while (m * m < n + 1)
+			++m;
+		return m;
+	}
+
+	/////////////// CONSTANT DEFINTION
+
+	template <size_t Zp>
+	size_t PolynomialModulus<Zp>::BarrettThreshold = 256;
+
+	template <size_t Zp>
+	size_t PolynomialModulus<Zp>::NttBarrettThreshold = 16;
+
+	/////////////// IMPLEMENTATION
+
+	template <size_t Zp>
+	PolynomialModulus<Zp>::PolynomialModulus(const Polynomial<Zp>& modulus) :
+		modulus_(modulus), deg_(modulus.deg())
+	{
+		if (modulus_ == Polynomial<Zp>::Zero)
+			throw std::runtime_error("Cannot divide by zero");
+		const cvec& f = modulus_.powers;
+		invertible_ = gcd(f[deg_].value(), Zp) == 1;
+		size_t threshold = NumberTheoreticTransform<Zp>::Supported(2 * deg_) ? NttBarrettThreshold : BarrettThreshold;
+		if (!invertible_ || deg_ < threshold || deg_ < 2)
+			return;
+
+		// Newton's iteration for g = rev(f)^-1: g <- g - g * (rev(f) * g - 1) doubles the number of correct terms
+		size_t len = deg_;
+		cvec reversed(f.rbegin() + (f.size() - deg_ - 1), f.rend());
+		reciprocal_.assign(1, f[deg_].inverse());
+		multiplier multiply;
+		for (size_t l = 1; l < len;)
+		{
+			size_t next = std::min(2 * l, len);
+			// e = rev(f) * g = 1 + x^l * (e[l] + e[l + 1] x + ...) mod x^next
+			cvec e(next + l - 1), correction(next - 1);
+			multiply(reversed.data(), next, reciprocal_.data(), l, e.data());
+			multiply(reciprocal_.data(), l, e.data() + l, next - l, correction.data());
+			reciprocal_.resize(next);
+			for (size_t i = l; i < next; ++i)
+				reciprocal_[i] = -correction[i - l];
+			l = next;
+		}
+	}
+
+	template <size_t Zp>
+	const Polynomial<Zp>& PolynomialModulus<Zp>::modulus() const
+	{
+		return modulus_;
+	}
+
+	template <size_t Zp>
+	size_t PolynomialModulus<Zp>::deg() const
+	{
+		return deg_;
+	}
+
+	template <size_t Zp>
+	void PolynomialModulus<Zp>::reduce_in_place(cvec& a) const
+	{
+		const size_t n = deg_;
+		size_t m = a.size();
+		while (m > 1 && !a[m - 1])
+			--m;
+		if (m > n)
+		{
+			const cvec& f = modulus_.powers;
+			if (reciprocal_.empty() || m > 2 * n)
+			{
+				Divider<ModularRing<Zp>>()(a.data(), m, f.data(), n + 1, nullptr);
+			}
+			else
+			{
+				// the quotient reversed is rev(a) * rev(f)^-1 mod x^k
+				size_t k = m - n;
+				multiplier multiply;
+				cvec top(k), product(2 * k - 1), quotient(k), qf(k + n);
+				std::reverse_copy(a.begin() + n, a.begin() + m, top.begin());
+				multiply(top.data(), k, reciprocal_.data(), k, product.data());
+				std::reverse_copy(product.begin(), product.begin() + k, quotient.begin());
+				// a - quotient * f, only the low n coefficients are left
+				multiply(quotient.data(), k, f.data(), n + 1, qf.data());
+				for (size_t i = 0; i < n; ++i)
+					a[i] -= qf[i];
+			}
+		}
+		a.resize(std::max<size_t>(n, 1));
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialModulus<Zp>::reduce(const Polynomial<Zp>& p) const
+	{
+		if (!invertible_)
+			return p.divide(modulus_).second;
+		// room for the deg_ coefficients of the result, reduce_in_place does not grow it then
+		cvec a;
+		a.reserve(std::max(p.powers.size(), deg_));
+		a.assign(p.powers.begin(), p.powers.end());
+		reduce_in_place(a);
+		return Polynomial<Zp>(std::move(a));
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialModulus<Zp>::mulmod(const Polynomial<Zp>& a, const Polynomial<Zp>& b) const
+	{
+		if (!invertible_)
+			return (a * b).divide(modulus_).second;
+		size_t na = a.deg() + 1, nb = b.deg() + 1;
+		// high zeros up to deg_ keep reduce_in_place from growing it
+		cvec product(std::max(na + nb - 1, deg_));
+		multiplier()(a.powers.data(), na, b.powers.data(), nb, product.data());
+		reduce_in_place(product);
+		return Polynomial<Zp>(std::move(product));
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialModulus<Zp>::frobenius_step(const Polynomial<Zp>& p) const
+	{
+		if (Polynomial<Zp>::SpreadPowers)
+			return reduce(p.frobenius(1));
+		return powmod(p, Zp);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialModulus<Zp>::powmod(const Polynomial<Zp>& base, size_t exponent) const
+	{
+		Polynomial<Zp> reduced = reduce(base), one = reduce(Polynomial<Zp>::One);
+		if (!Polynomial<Zp>::SpreadPowers || exponent < Zp)
+			return window_power(reduced, exponent, one,
+				[this](const Polynomial<Zp>& a, const Polynomial<Zp>& b) { return mulmod(a, b); },
+				[this](const Polynomial<Zp>& a) { return mulmod(a, a); });
+		// base^d mod f for every digit d
+		std::vector<Polynomial<Zp>> digit_powers(1, one);
+		for (size_t d = 1; d < Zp; ++d)
+			digit_powers.push_back(mulmod(digit_powers.back(), reduced));
+		std::vector<size_t> digits;
+		for (; exponent; exponent /= Zp)
+			digits.push_back(exponent % Zp);
+		// Horner's scheme in base Zp from the top digit: res = res^Zp * base^d
+		Polynomial<Zp> res = digit_powers[digits.back()];
+		for (size_t i = digits.size() - 1; i-- > 0;)
+		{
+			res = frobenius_step(res);
+			if (digits[i])
+				res = mulmod(res, digit_powers[digits[i]]);
+		}
+		return res;
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialModulus<Zp>::frobenius(const Polynomial<Zp>& base, size_t n) const
+	{
+		Polynomial<Zp> res = reduce(base);
+		for (size_t i = 0; i < n; ++i)
+			res = frobenius_step(res);
+		return res;
+	}
+
+	template <size_t Zp>
+	std::vector<Polynomial<Zp>> PolynomialModulus<Zp>::power_table(const Polynomial<Zp>& h, size_t m) const
+	{
+		Polynomial<Zp> reduced = reduce(h);
+		std::vector<Polynomial<Zp>> table(1, reduce(Polynomial<Zp>::One));
+		table.reserve(m + 1);
+		for (size_t i = 0; i < m; ++i)
+			table.push_back(mulmod(table.back(), reduced));
+		return table;
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialModulus<Zp>::compose(const Polynomial<Zp>& g, const std::vector<Polynomial<Zp>>& table) const
+	{
+		if (table.size() < 2)
+			throw std::runtime_error("Composition needs h^0 and h^1 at least");
+		const size_t m = table.size() - 1, blocks = g.deg() / m + 1;
+		const cvec& c = g.powers;
+		Polynomial<Zp> res = Polynomial<Zp>::Zero;
+		// Horner's scheme from the top block: res = res * h^m + sum g[b m + j] h^j
+		for (size_t b = blocks; b-- > 0;)
+		{
+			cvec block(std::max<size_t>(deg_, 1));
+			for (size_t j = 0, idx = b * m; j < m && idx < c.size(); ++j, ++idx)
+			{
+				if (!c[idx])
+					continue;
+				const cvec& power = table[j].powers;
+				for (size_t k = 0; k < power.size(); ++k)
+					block[k] += c[idx] * power[k];
+			}
+			Polynomial<Zp> part(std::move(block));
+			res = b + 1 == blocks ? std::move(part) : mulmod(res, table[m]) + part;
+		}
+		return res;
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> PolynomialModulus<Zp>::compose(const Polynomial<Zp>& g, const Polynomial<Zp>& h) const
+	{
+		return compose(g, power_table(h, composition_block(g.deg())));
+	}
+
+	inline PolynomialModulus<2>::PolynomialModulus(const Polynomial<2>& modulus) : modulus_(modulus)
+	{
+		if (modulus_ == Polynomial<2>::Zero)
+			throw std::runtime_error("Cannot divide by zero");
+	}
+
+	inline const Polynomial<2>& PolynomialModulus<2>::modulus() const
+	{
+		return modulus_;
+	}
+
+	inline size_t PolynomialModulus<2>::deg() const
+	{
+		return modulus_.deg();
+	}
+
+	inline Polynomial<2> PolynomialModulus<2>::reduce(const Polynomial<2>& p) const
+	{
+		return p.divide(modulus_).second;
+	}
+
+	inline Polynomial<2> PolynomialModulus<2>::mulmod(const Polynomial<2>& a, const Polynomial<2>& b) const
+	{
+		return (&a == &b ? a.square() : a * b).divide(modulus_).second;
+	}
+
+	inline Polynomial<2> PolynomialModulus<2>::powmod(const Polynomial<2>& base, size_t exponent) const
+	{
+		return Polynomial<2>::PowMod(base, exponent, modulus_);
+	}
+
+	inline Polynomial<2> PolynomialModulus<2>::frobenius(const Polynomial<2>& base, size_t n) const
+	{
+		return Polynomial<2>::FrobeniusMod(base, n, modulus_);
+	}
+
+	inline std::vector<Polynomial<2>> PolynomialModulus<2>::power_table(const Polynomial<2>& h, size_t m) const
+	{
+		Polynomial<2> reduced = reduce(h);
+		std::vector<Polynomial<2>> table(1, reduce(Polynomial<2>::One));
+		table.reserve(m + 1);
+		for (size_t i = 0; i < m; ++i)
+			table.push_back(mulmod(table.back(), reduced));
+		return table;
+	}
+
+	inline Polynomial<2> PolynomialModulus<2>::compose(const Polynomial<2>& g, const std::vector<Polynomial<2>>& table) const
+	{
+		if (table.size() < 2)
+			throw std::runtime_error("Composition needs h^0 and h^1 at least");
+		const size_t m = table.size() - 1, blocks = g.deg() / m + 1;
+		Polynomial<2> res = Polynomial<2>::Zero;
+		for (size_t b = blocks; b-- > 0;)
+		{
+			Polynomial<2> part = Polynomial<2>::Zero;
+			for (size_t j = 0, idx = b * m; j < m && idx <= g.deg(); ++j, ++idx)
+			{
+				if (g[idx])
+					part += table[j];
+			}
+			res = b + 1 == blocks ? part : mulmod(res, table[m]) + part;
+		}
+		return res;
+	}
+
+	inline Polynomial<2> PolynomialModulus<2>::compose(const Polynomial<2>& g, const Polynomial<2>& h) const
+	{
+		return compose(g, power_table(h, composition_block(g.deg())));
+	}
+}
@@ -0,0 +1,346 @@
+#include "RuntimePolynomial.h"
+
+namespace Algebra
+{
+	/////////////// CONSTANT DEFINTION
+
+	OUTPUT_MODE RuntimePolynomial::OutputMode = OUTPUT_MODE::MINIMAL;
+
+	/////////////// IMPLEMENTATION
+
+	void RuntimePolynomial::check_ring(const RuntimePolynomial& p) const
+	{
+		if (ring_ != p.ring_)
+			throw std::runtime_error("Polynomials are taken modulo different numbers");
+	}
+
+	RuntimePolynomial::cvec RuntimePolynomial::coefficients(const std::vector<long long>& powers) const
+	{
+		cvec res(std::max<size_t>(powers.size(), 1));
+		for (size_t i = 0, sz = powers.size(); i < sz; ++i)
+			res[i] = ring_.from_signed(powers[i]);
+		return res;
+	}
+
+	RuntimePolynomial::RuntimePolynomial(const MontgomeryRing& ring, const cvec& powers) :
+		ring_(ring), powers(powers)
+	{
+		if (this->powers.empty())
+			this->powers.push_back(0);
+	}
+
+	RuntimePolynomial::RuntimePolynomial(const MontgomeryRing& ring, const std::initializer_list<long long>& l) :
+		ring_(ring), powers(coefficients(l))
+	{
+	}
+
+	RuntimePolynomial::RuntimePolynomial(const MontgomeryRing& ring, const std::vector<long long>& powers) :
+		ring_(ring), powers(coefficients(powers))
+	{
+	}
+
+	RuntimePolynomial RuntimePolynomial::One(const MontgomeryRing& ring)
+	{
+		return RuntimePolynomial(ring, { 1 });
+	}
+
+	RuntimePolynomial RuntimePolynomial::X(const MontgomeryRing& ring)
+	{
+		return RuntimePolynomial(ring, { 0, 1 });
+	}
+
+	RuntimePolynomial RuntimePolynomial::Zero(const MontgomeryRing& ring)
+	{
+		return RuntimePolynomial(ring, { 0 });
+	}
+
+	const MontgomeryRing& RuntimePolynomial::ring() const
+	{
+		return ring_;
+	}
+
+	size_t RuntimePolynomial::size() const
+	{
+		return powers.size();
+	}
+
+	size_t RuntimePolynomial::operator[](size_t idx) const
+	{
+		return size_t(ring_.get(powers[idx]));
+	}
+
+	void RuntimePolynomial::assign(const std::vector<long long>& p)
+	{
+		powers = coefficients(p);
+	}
+
+	void RuntimePolynomial::set(size_t idx, long long value)
+	{
+		if (idx >= powers.size())
+			powers.resize(idx + 1);
+		powers[idx] = ring_.from_signed(value);
+	}
+
+	size_t RuntimePolynomial::eval(long long x_value) const
+	{
+		coefficient x = ring_.from_signed(x_value), res = 0;
+		for (size_t i = powers.size(); i-- > 0;)
+			res = ring_.add(ring_.mul(res, x), powers[i]);
+		return size_t(ring_.get(res));
+	}
+
+	size_t RuntimePolynomial::deg() const
+	{
+		for (size_t i = powers.size() - 1; i != size_t(-1); --i)
+		{
+			if (powers[i])
+				return i;
+		}
+		return 0;
+	}
+
+	RuntimePolynomial RuntimePolynomial::derivative() const
+	{
+		RuntimePolynomial res = shift_back(1);
+		for (size_t i = 0, sz = res.size(); i < sz; ++i)
+			res.powers[i] = ring_.mul(res.powers[i], ring_.from(i + 1));
+		return res;
+	}
+
+	RuntimePolynomial RuntimePolynomial::shift_back(size_t shift) const
+	{
+		if (shift == 0)
+			return *this;
+		size_t dg = deg();
+		if (shift > dg)
+			return Zero(ring_);
+		return RuntimePolynomial(ring_, cvec(powers.begin() + shift, powers.begin() + dg + 1));
+	}
+
+	RuntimePolynomial RuntimePolynomial::shift(size_t shift) const
+	{
+		if (shift == 0)
+			return *this;
+		cvec resv(powers.size() + shift);
+		std::copy(powers.begin(), powers.end(), resv.begin() + shift);
+		return RuntimePolynomial(ring_, resv);
+	}
+
+	RuntimePolynomial& RuntimePolynomial::operator+=(const RuntimePolynomial& p)
+	{
+		check_ring(p);
+		if (powers.size() < p.size())
+			powers.resize(p.size());
+		for (size_t i = 0, sz = p.size(); i < sz; ++i)
+			powers[i] = ring_.add(powers[i], p.powers[i]);
+		return *this;
+	}
+
+	RuntimePolynomial RuntimePolynomial::operator+(const RuntimePolynomial& p) const
+	{
+		RuntimePolynomial res = *this;
+		return res += p;
+	}
+
+	RuntimePolynomial& RuntimePolynomial::operator-=(const RuntimePolynomial& p)
+	{
+		check_ring(p);
+		if (powers.size() < p.size())
+			powers.resize(p.size());
+		for (size_t i = 0, sz = p.size(); i < sz; ++i)
+			powers[i] = ring_.sub(powers[i], p.powers[i]);
+		return *this;
+	}
+
+	RuntimePolynomial RuntimePolynomial::operator-(const RuntimePolynomial& p) const
+	{
+		RuntimePolynomial res = *this;
+		return res -= p;
+	}
+
+	RuntimePolynomial& RuntimePolynomial::operator*=(const RuntimePolynomial& p)
+	{
+		check_ring(p);
+		size_t na = deg() + 1, nb = p.deg() + 1;
+		cvec res(na + nb - 1);
+		Multiplier<MontgomeryRing> multiply(ring_);
+		multiply(powers.data(), na, p.powers.data(), nb, res.data());
+		powers.swap(res);
+		return *this;
+	}
+
+	RuntimePolynomial RuntimePolynomial::operator*(const RuntimePolynomial& p) const
+	{
+		RuntimePolynomial res = *this;
+		return res *= p;
+	}
+
+	RuntimePolynomial RuntimePolynomial::operator*(long long number) const
+	{
+		coefficient c = ring_.from_signed(number);
+		RuntimePolynomial res = *this;
+		for (auto& p : res.powers)
+			p = ring_.mul(p, c);
+		return res;
+	}
+
+	RuntimePolynomial& RuntimePolynomial::addmul(const RuntimePolynomial& a, const RuntimePolynomial& b)
+	{
+		return accumulate(a, b, false);
+	}
+
+	RuntimePolynomial& RuntimePolynomial::submul(const RuntimePolynomial& a, const RuntimePolynomial& b)
+	{
+		return accumulate(a, b, true);
+	}
+
+	RuntimePolynomial& RuntimePolynomial::accumulate(const RuntimePolynomial& a, const RuntimePolynomial& b, bool subtract)
+	{
+		check_ring(a);
+		check_ring(b);
+		// the accumulator must not overlap the operands
+		if (&a == this || &b == this)
+			return subtract ? *this -= a * b : *this += a * b;
+		size_t na = a.deg() + 1, nb = b.deg() + 1;
+		if (powers.size() < na + nb - 1)
+			powers.resize(na + nb - 1);
+		Multiplier<MontgomeryRing> multiply(ring_);
+		multiply.accumulate(a.powers.data(), na, b.powers.data(), nb, powers.data(), subtract);
+		return *this;
+	}
+
+	RuntimePolynomial RuntimePolynomial::square() const
+	{
+		size_t n = deg() + 1;
+		cvec res(2 * n - 1);
+		Multiplier<MontgomeryRing> multiply(ring_);
+		multiply(powers.data(), n, powers.data(), n, res.data());
+		return RuntimePolynomial(ring_, res);
+	}
+
+	RuntimePolynomial RuntimePolynomial::negate() const
+	{
+		RuntimePolynomial res = *this;
+		for (auto& p : res.powers)
+			p = ring_.sub(0, p);
+		return res;
+	}
+
+	std::pair<RuntimePolynomial, RuntimePolynomial> RuntimePolynomial::divide(const RuntimePolynomial& p) const
+	{
+		check_ring(p);
+		if (p == Zero(ring_))
+			throw std::runtime_error("Cannot divide by zero");
+
+		size_t dt = deg(), dp = p.deg();
+		if (dp > dt)
+			return std::make_pair(Zero(ring_), *this);
+		cvec quotient(dt - dp + 1), remainder(powers.begin(), powers.begin() + dt + 1);
+		Divider<MontgomeryRing> long_divide(ring_);
+		long_divide(remainder.data(), dt + 1, p.powers.data(), dp + 1, quotient.data());
+		remainder.resize(std::max<size_t>(dp, 1));
+		return std::make_pair(RuntimePolynomial(ring_, quotient), RuntimePolynomial(ring_, remainder));
+	}
+
+	RuntimePolynomial RuntimePolynomial::operator%(const RuntimePolynomial& p) const
+	{
+		return divide(p).second;
+	}
+
+	RuntimePolynomial& RuntimePolynomial::operator%=(const RuntimePolynomial& p)
+	{
+		return *this = *this % p;
+	}
+
+	RuntimePolynomial RuntimePolynomial::operator/(const RuntimePolynomial& p) const
+	{
+		return divide(p).first;
+	}
+
+	RuntimePolynomial& RuntimePolynomial::operator/=(const RuntimePolynomial& p)
+	{
+		return *this = *this / p;
+	}
+
+	RuntimePolynomial RuntimePolynomial::pow(size_t power) const
+	{
+		return window_power(*this, power, One(ring_),
+			[](const RuntimePolynomial& a, const RuntimePolynomial& b) { return a * b; },
+			[](const RuntimePolynomial& a) { return a.square(); });
+	}
+
+	bool RuntimePolynomial::operator==(const RuntimePolynomial& p) const
+	{
+		if (ring_ != p.ring_)
+			return false;
+		size_t dt = deg(), dp = p.deg();
+		if (dt != dp)
+			return false;
+		return std::equal(powers.begin(), powers.begin() + dt + 1, p.powers.begin());
+	}
+
+	bool RuntimePolynomial::operator!=(const RuntimePolynomial& p) const
+	{
+		return !(*this == p);
+	}
+
+	bool RuntimePolynomial::operator<(const RuntimePolynomial& p) const
+	{
+		size_t dt = deg(), dp = p.deg();
+		if (dt < dp)
+			return true;
+		if (dt > dp)
+			return false;
+		return (*this)[dt] < p[dp];
+	}
+
+	bool RuntimePolynomial::operator>(const RuntimePolynomial& p) const
+	{
+		return !(*this < p);
+	}
+
+	RuntimePolynomial RuntimePolynomial::Gcd(const RuntimePolynomial& p1, const RuntimePolynomial& p2)
+	{
+		p1.check_ring(p2);
+		cvec g;
+		Euclid<MontgomeryRing> euclid(p1.ring_);
+		if (euclid(p1.powers.data(), p1.size(), p2.powers.data(), p2.size(), g))
+			return RuntimePolynomial(p1.ring_, g);
+		// a remainder has a zero divisor as leading coefficient
+		RuntimePolynomial a = p1, b = p2, zero = Zero(p1.ring_);
+		while (b != zero)
+		{
+			auto r = a % b;
+			a = b;
+			b = r;
+		}
+		return a;
+	}
+
+	RuntimePolynomial RuntimePolynomial::ExpandedGcd(RuntimePolynomial a, RuntimePolynomial b, RuntimePolynomial mod)
+	{
+		const MontgomeryRing& ring = mod.ring_;
+		const RuntimePolynomial one = One(ring), zero = Zero(ring);
+		a %= mod;
+		b %= mod;
+		if (a == one)
+			return b;
+		// y * a = g mod mod, so y * (b / g) is a solution modulo mod / g
+		cvec g, y;
+		Euclid<MontgomeryRing> euclid(ring);
+		if (!euclid(mod.powers.data(), mod.size(), a.powers.data(), a.size(), g, nullptr, &y))
+			throw std::runtime_error("Cannot find a solution");
+		RuntimePolynomial gp(ring, g);
+		auto split = b.divide(gp);
+		if (split.second != zero)
+			throw std::runtime_error("Cannot find a solution");
+		return RuntimePolynomial(ring, y) * split.first % (mod / gp);
+	}
+
+	RuntimePolynomial RuntimePolynomial::PowMod(const RuntimePolynomial& base, size_t exponent, const RuntimePolynomial& modulus)
+	{
+		return window_power(base % modulus, exponent, One(modulus.ring_) % modulus,
+			[&modulus](const RuntimePolynomial& a, const RuntimePolynomial& b) { return a * b % modulus; },
+			[&modulus](const RuntimePolynomial& a) { return a.square() % modulus; });
+	}
+}
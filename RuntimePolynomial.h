@@ -0,0 +1,145 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include "Polynomial.h"
+#include "MontgomeryRing.h"
+#include "Multiplication.h"
+#include "Division.h"
+#include "Gcd.h"
+#include "Exponentiation.h"
+
+
+namespace Algebra
+{
+	// Polynomial over Z/m with the modulus chosen at runtime (odd m below 2^63, a prime for division).
+	// Coefficients are kept in Montgomery form of MontgomeryRing; multiplication and division
+	// run the same kernels as Polynomial<Zp> (Multiplier, Divider). Operands have to share the modulus.
+	class RuntimePolynomial
+	{
+		typedef MontgomeryRing::value_type coefficient;
+		typedef std::vector<coefficient> cvec;
+
+		MontgomeryRing ring_;
+		cvec powers;
+
+		// throws if p is taken modulo another number
+		void			check_ring		(const RuntimePolynomial& p) const;
+		cvec			coefficients	(const std::vector<long long>& powers) const;
+		RuntimePolynomial&	accumulate	(const RuntimePolynomial& a, const RuntimePolynomial& b, bool subtract);
+	protected:
+		// use this to construct from coefficients already in Montgomery form
+		RuntimePolynomial				(const MontgomeryRing& ring, const cvec& powers);
+
+	public:
+		static OUTPUT_MODE							OutputMode;
+
+		static RuntimePolynomial	One			(const MontgomeryRing& ring);
+		static RuntimePolynomial	X			(const MontgomeryRing& ring);
+		static RuntimePolynomial	Zero		(const MontgomeryRing& ring);
+
+		RuntimePolynomial				(const MontgomeryRing& ring, const std::initializer_list<long long>& l);
+		RuntimePolynomial				(const MontgomeryRing& ring, const std::vector<long long>& powers);
+
+		//// CONTROL FUNCTIONS AND OPERATORS
+
+		const MontgomeryRing&	ring	()							const;
+		size_t			size()										const;
+
+		size_t			operator[]		(size_t idx)				const;
+
+
+		void			assign			(const std::vector<long long>& p);
+		void			set				(size_t idx, long long value);
+
+		// Horner's scheme: O(n)
+		size_t			eval			(long long x_value)			const;
+
+		size_t			deg				()							const;
+
+		//// ALGEBRAIC FUNCTIONS AND OPERATORS
+
+		RuntimePolynomial	derivative	()							const;
+		RuntimePolynomial	shift_back	(size_t shift)				const;
+		RuntimePolynomial	shift		(size_t shift)				const;
+
+		/////// ARITHMETIC
+
+		RuntimePolynomial&	operator +=	(const RuntimePolynomial& p);
+		RuntimePolynomial	operator +	(const RuntimePolynomial& p) const;
+
+		RuntimePolynomial&	operator -=	(const RuntimePolynomial& p);
+		RuntimePolynomial	operator -	(const RuntimePolynomial& p) const;
+
+		// schoolbook, Karatsuba or Toom-3 by operand size, see Multiplier
+		RuntimePolynomial&	operator *=	(const RuntimePolynomial& p);
+		RuntimePolynomial	operator *	(const RuntimePolynomial& p) const;
+		RuntimePolynomial	operator *	(long long number)			const;
+		// this += a * b and this -= a * b without the product temporary, see Multiplier::accumulate
+		RuntimePolynomial&	addmul		(const RuntimePolynomial& a, const RuntimePolynomial& b);
+		RuntimePolynomial&	submul		(const RuntimePolynomial& a, const RuntimePolynomial& b);
+		// this * this with the squaring kernels of Multiplier
+		RuntimePolynomial	square		()							const;
+		RuntimePolynomial	negate		()							const;
+
+		// Throws if the leading coefficient of p is not invertible
+		std::pair<RuntimePolynomial, RuntimePolynomial> divide(const RuntimePolynomial& p) const;
+		RuntimePolynomial	operator %	(const RuntimePolynomial& p) const;
+		RuntimePolynomial&	operator %=	(const RuntimePolynomial& p);
+		RuntimePolynomial	operator /	(const RuntimePolynomial& p) const;
+		RuntimePolynomial&	operator /=	(const RuntimePolynomial& p);
+
+		// Sliding window: log2(power) squarings and about log2(power) / w other multiplications
+		RuntimePolynomial	pow			(size_t power)				const;
+
+		//////// LOGICAL
+
+		bool			operator ==		(const RuntimePolynomial& p) const;
+		bool			operator !=		(const RuntimePolynomial& p) const;
+
+		bool			operator <		(const RuntimePolynomial& p) const;
+		bool			operator >		(const RuntimePolynomial& p) const;
+
+		//// OUTPUT
+
+		friend std::ostream& operator << (std::ostream &s, const RuntimePolynomial &p) {
+			const size_t last_index = p.size() - 1;
+
+			bool printed = false;
+			for (size_t i = last_index; i != size_t(-1); --i) {
+				if (p[i] != 0 || OutputMode == OUTPUT_MODE::CANONICAL)
+				{
+					// insert operator only AFTER the first (thus, we are sure, that this operator is needed)
+					if (printed)
+					{
+						s << " + ";
+					}
+					if (i == 0 || p[i] != 1)
+						s << p[i];
+
+					if (i == 1) {
+						s << "x";
+					}
+					else if (i > 1) { // i > 1
+						s << "x^" << i;
+					}
+					printed = true;
+				}
+			}
+			if (!printed)
+				s << "0";
+			return s;
+		}
+
+		// Half-GCD or classical remainder sequence by size, see Euclid
+		static RuntimePolynomial	Gcd			(const RuntimePolynomial& p1, const RuntimePolynomial& p2);
+		static RuntimePolynomial	ExpandedGcd	(RuntimePolynomial a, RuntimePolynomial b, RuntimePolynomial mod);
+
+		// base^exponent mod modulus: sliding window with reduction after every product, O(deg modulus) memory
+		static RuntimePolynomial	PowMod		(const RuntimePolynomial& base, size_t exponent, const RuntimePolynomial& modulus);
+	};
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <vector>
+#include <stdexcept>
+#include "ModInt.h"
+#include "Polynomial.h"
+
+
+namespace Algebra
+{
+	// Products of (x - x_i) over a balanced binary tree of the points: the root is prod (x - x_i), every inner node
+	// the product of its children, blocks of at most LeafSize points are leaves.
+	// Evaluation reduces a polynomial down the tree (remainder tree) and Horner finishes in the leaves,
+	// interpolation combines Lagrange weights up the tree: both O(M(n) log n) for n points.
+	// Every node keeps its PolynomialModulus, so repeated evaluations at the same points reuse the reciprocals
+	template <size_t Zp>
+	class SubproductTree
+	{
+		typedef Polynomial<Zp> poly;
+		typedef ModInt<Zp> coefficient;
+
+		struct Node
+		{
+			// points [begin, end)
+			size_t begin, end;
+			// children, none for a leaf
+			size_t left, right;
+			PolynomialModulus<Zp> product;
+		};
+
+		std::vector<coefficient> points_;
+		// the root is the last one
+		std::vector<Node> nodes_;
+
+		size_t			build			(size_t begin, size_t end);
+		void			evaluate		(size_t node, const poly& f, std::vector<size_t>& res) const;
+		// sum of weights[i] * product / (x - x_i) over the points of the node
+		poly			combine			(size_t node, const std::vector<coefficient>& weights) const;
+		static poly		from			(const std::vector<coefficient>& c);
+
+	public:
+		// Points per leaf: below it a product is built one factor at a time and evaluated by Horner's scheme
+		static size_t						LeafSize;
+
+		// throws for no points
+		explicit SubproductTree			(const std::vector<size_t>& points);
+
+		size_t			size			()							const;
+		// prod (x - x_i)
+		const poly&		root			()							const;
+
+		// f(x_i) for every point
+		std::vector<size_t>	evaluate	(const poly& f)				const;
+		// the polynomial of degree below size() with values[i] at x_i, throws if two points are equal
+		poly			interpolate		(const std::vector<size_t>& values) const;
+	};
+
+	/////////////// CONSTANT DEFINTION
+
+	template <size_t Zp>
+	size_t SubproductTree<Zp>::LeafSize = 32;
+
+	/////////////// IMPLEMENTATION
+
+	template <size_t Zp>
+	SubproductTree<Zp>::SubproductTree(const std::vector<size_t>& points)
+	{
+		if (points.empty())
+			throw std::runtime_error("Subproduct tree needs at least one point");
+		for (auto x : points)
+			points_.push_back(coefficient(static_cast<uint64_t>(x)));
+		nodes_.reserve(2 * (points.size() / std::max<size_t>(LeafSize, 1)) + 1);
+		build(0, points_.size());
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> SubproductTree<Zp>::from(const std::vector<coefficient>& c)
+	{
+		poly res = poly::Zero;
+		for (size_t i = c.size(); i-- > 0;)
+			res.set(i, static_cast<long long>(c[i].value()));
+		return res;
+	}
+
+	template <size_t Zp>
+	size_t SubproductTree<Zp>::build(size_t begin, size_t end)
+	{
+		size_t left = size_t(-1), right = size_t(-1);
+		poly product = poly::One;
+		if (end - begin <= std::max<size_t>(LeafSize, 1))
+		{
+			// c = c * (x - x_i) one factor at a time
+			std::vector<coefficient> c(1, coefficient(1));
+			for (size_t i = begin; i < end; ++i)
+			{
+				c.push_back(c.back());
+				for (size_t j = c.size() - 2; j > 0; --j)
+					c[j] = c[j - 1] - points_[i] * c[j];
+				c[0] = -(points_[i] * c[0]);
+			}
+			product = from(c);
+		}
+		else
+		{
+			size_t middle = begin + (end - begin) / 2;
+			left = build(begin, middle);
+			right = build(middle, end);
+			product = nodes_[left].product.modulus() * nodes_[right].product.modulus();
+		}
+		nodes_.push_back(Node{ begin, end, left, right, PolynomialModulus<Zp>(product) });
+		return nodes_.size() - 1;
+	}
+
+	template <size_t Zp>
+	size_t SubproductTree<Zp>::size() const
+	{
+		return points_.size();
+	}
+
+	template <size_t Zp>
+	const Polynomial<Zp>& SubproductTree<Zp>::root() const
+	{
+		return nodes_.back().product.modulus();
+	}
+
+	template <size_t Zp>
+	void SubproductTree<Zp>::evaluate(size_t node, const poly& f, std::vector<size_t>& res) const
+	{
+		const Node& n = nodes_[node];
+		poly rest = n.product.reduce(f);
+		if (n.left != size_t(-1))
+		{
+			evaluate(n.left, rest, res);
+			evaluate(n.right, rest, res);
+			return;
+		}
+		for (size_t i = n.begin; i < n.end; ++i)
+		{
+			coefficient value;
+			for (size_t k = rest.deg() + 1; k-- > 0;)
+				value = value * points_[i] + coefficient(static_cast<uint64_t>(rest[k]));
+			res[i] = size_t(value.value());
+		}
+	}
+
+	template <size_t Zp>
+	std::vector<size_t> SubproductTree<Zp>::evaluate(const poly& f) const
+	{
+		std::vector<size_t> res(points_.size());
+		evaluate(nodes_.size() - 1, f, res);
+		return res;
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> SubproductTree<Zp>::combine(size_t node, const std::vector<coefficient>& weights) const
+	{
+		const Node& n = nodes_[node];
+		if (n.left != size_t(-1))
+		{
+			poly res = combine(n.left, weights) * nodes_[n.right].product.modulus();
+			res.addmul(combine(n.right, weights), nodes_[n.left].product.modulus());
+			return res;
+		}
+		// product / (x - x_i) by synthetic division, q[k - 1] = c[k] + x_i q[k]
+		const poly& product = n.product.modulus();
+		const size_t d = product.deg();
+		std::vector<coefficient> c(d + 1), acc(d);
+		for (size_t k = 0; k <= d; ++k)
+			c[k] = coefficient(static_cast<uint64_t>(product[k]));
+		for (size_t i = n.begin; i < n.end; ++i)
+		{
+			coefficient q = c[d];
+			for (size_t k = d; k-- > 0;)
+			{
+				acc[k] += weights[i] * q;
+				q = c[k] + points_[i] * q;
+			}
+		}
+		return from(acc);
+	}
+
+	template <size_t Zp>
+	Polynomial<Zp> SubproductTree<Zp>::interpolate(const std::vector<size_t>& values) const
+	{
+		if (values.size() != points_.size())
+			throw std::runtime_error("Interpolation needs one value per point");
+		// Lagrange: f = sum y_i / m'(x_i) * m / (x - x_i) for m = prod (x - x_j)
+		std::vector<size_t> derivative = evaluate(root().derivative());
+		std::vector<coefficient> weights(values.size());
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			if (derivative[i] == 0)
+				throw std::runtime_error("Interpolation points have to be distinct");
+			weights[i] = coefficient(static_cast<uint64_t>(values[i])) * coefficient(static_cast<uint64_t>(derivative[i])).inverse();
+		}
+		return combine(nodes_.size() - 1, weights);
+	}
+}
@@ -0,0 +1,97 @@
+#include "WorkStealingScheduler.h"
+#include <algorithm>
+
+size_t Algebra::WorkStealingScheduler::DefaultChunk = 1024;
+
+Algebra::WorkStealingScheduler::WorkStealingScheduler(size_t count, size_t workers, size_t chunk) :
+	count_(count), chunk_(std::max<size_t>(chunk, 1)), limit_(count)
+{
+	if (workers == 0)
+		workers = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	size_t chunks = (count_ + chunk_ - 1) / chunk_;
+	// no more workers than chunks, but at least the calling thread
+	workers = std::max<size_t>(std::min(workers, chunks), 1);
+	for (size_t worker = 0; worker < workers; ++worker)
+	{
+		shares_.emplace_back(new Share());
+		shares_.back()->begin = chunks * worker / workers;
+		shares_.back()->end = chunks * (worker + 1) / workers;
+	}
+}
+
+size_t Algebra::WorkStealingScheduler::workers() const
+{
+	return shares_.size();
+}
+
+size_t Algebra::WorkStealingScheduler::limit() const
+{
+	return limit_.load(std::memory_order_acquire);
+}
+
+void Algebra::WorkStealingScheduler::cancel_from(size_t index)
+{
+	size_t current = limit_.load(std::memory_order_acquire);
+	while (index < current && !limit_.compare_exchange_weak(current, index, std::memory_order_acq_rel))
+		;
+}
+
+bool Algebra::WorkStealingScheduler::next(size_t worker, size_t& begin, size_t& end)
+{
+	Share& own = *shares_[worker];
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> guard(own.lock);
+			if (own.begin < own.end)
+			{
+				size_t chunk = own.begin++;
+				begin = chunk * chunk_;
+				end = std::min(begin + chunk_, count_);
+				// everything behind the limit is cancelled, the rest of the share too
+				if (begin < limit())
+					return true;
+				own.begin = own.end;
+			}
+		}
+		if (!steal(worker))
+			return false;
+	}
+}
+
+bool Algebra::WorkStealingScheduler::steal(size_t worker)
+{
+	while (true)
+	{
+		// the largest share below the limit, it may have shrunk by the time the victim is locked again
+		size_t limit_chunk = (limit() + chunk_ - 1) / chunk_, victim = shares_.size(), best = 0;
+		for (size_t i = 0; i < shares_.size(); ++i)
+		{
+			if (i == worker)
+				continue;
+			std::lock_guard<std::mutex> guard(shares_[i]->lock);
+			size_t end = std::min(shares_[i]->end, limit_chunk);
+			size_t left = shares_[i]->begin < end ? end - shares_[i]->begin : 0;
+			if (left > best)
+				best = left, victim = i;
+		}
+		if (victim == shares_.size())
+			return false;
+		size_t begin, end;
+		{
+			Share& target = *shares_[victim];
+			std::lock_guard<std::mutex> guard(target.lock);
+			target.end = std::min(target.end, limit_chunk);
+			if (target.begin >= target.end)
+				continue;
+			// the back half, rounded up so that a last chunk can be taken too
+			begin = target.end - (target.end - target.begin + 1) / 2;
+			end = target.end;
+			target.end = begin;
+		}
+		std::lock_guard<std::mutex> guard(shares_[worker]->lock);
+		shares_[worker]->begin = begin;
+		shares_[worker]->end = end;
+		return true;
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <exception>
+
+
+namespace Algebra
+{
+	// Runs a body over the indices [0, count) in chunks on several threads.
+	// Every worker starts with an equal contiguous share of the chunks and takes them from its front;
+	// a worker which runs dry steals the back half of the largest share left. Chunks at or above limit() are skipped,
+	// so a search can cancel everything behind the best index found so far and stay deterministic.
+	class WorkStealingScheduler
+	{
+		// [begin, end) in chunks, the owner takes from begin, thieves from end
+		struct Share
+		{
+			std::mutex lock;
+			size_t begin, end;
+		};
+
+		std::vector<std::unique_ptr<Share>> shares_;
+		size_t count_, chunk_;
+		std::atomic<size_t> limit_;
+
+		// next chunk of the worker as [begin, end) of indices, false once there is nothing left to run or steal
+		bool			next			(size_t worker, size_t& begin, size_t& end);
+		bool			steal			(size_t worker);
+
+	public:
+		// Indices per chunk when none is given
+		static size_t						DefaultChunk;
+
+		// workers = 0 takes std::thread::hardware_concurrency()
+		WorkStealingScheduler			(size_t count, size_t workers = 0, size_t chunk = DefaultChunk);
+
+		size_t			workers			()							const;
+		size_t			limit			()							const;
+		// indices from index on are not handed out any more, limit() only decreases
+		void			cancel_from		(size_t index);
+
+		// body(begin, end) for every chunk, on workers() threads including the calling one.
+		// The first exception thrown by a body cancels the rest and is rethrown here
+		template <class Body>
+		void			run				(Body body);
+	};
+
+	/////////////// IMPLEMENTATION
+
+	template <class Body>
+	void WorkStealingScheduler::run(Body body)
+	{
+		std::exception_ptr error;
+		std::mutex error_lock;
+		auto work = [&](size_t worker)
+		{
+			size_t begin, end;
+			try
+			{
+				while (next(worker, begin, end))
+					body(begin, end);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> guard(error_lock);
+				if (!error)
+					error = std::current_exception();
+				cancel_from(0);
+			}
+		};
+		std::vector<std::thread> threads;
+		for (size_t worker = 1; worker < shares_.size(); ++worker)
+			threads.emplace_back(work, worker);
+		work(0);
+		for (auto& thread : threads)
+			thread.join();
+		if (error)
+			std::rethrow_exception(error);
+	}
+}
@@ -1,8 +1,12 @@
 #include <iostream>
 #include <vector>
+#include <chrono>
+#include <random>
 
+#include "AllocationCounter.h"
 #include "Factorizer.h"
 #include "Polynomial.h"
+#include "RuntimePolynomial.h"
 #include "GaloisFieldExtension.h"
 #include "ConsecutivePolynomialGenerator.h"
 #include "RandomPolynomialGenerator.h"
@@ -10,6 +14,15 @@
 
 using namespace Algebra;
 
+// heap allocations made by f
+template <class F>
+size_t count_allocations(F f)
+{
+	size_t before = allocation_count();
+	f();
+	return allocation_count() - before;
+}
+
 int main() {
 	Polynomial<5> p1 = { 2, 1, 2, -1, -1, -1, -2, -3, -4, 1, 1, 2, 3, 4, 8 };
 	Polynomial<5> p2 = { 4, 3 };
@@ -81,6 +94,132 @@ int main() {
 	RandomPolynomialGenerator<Zp, degree> rgen;
 	std::cout << "RANDOM Irreducible over Z" << Zp << " with degree " << degree << " : " << GaloisFieldExtension<Zp, degree>::FindIrreducible(rgen) << std::endl;
 
+	// Multiplication algorithms over NTT-friendly prime 998244353 = 119 * 2^23 + 1
+	constexpr const size_t NttPrime = 998244353;
+	typedef Multiplier<ModularRing<NttPrime>> NttMultiplier;
+	const std::pair<MULTIPLICATION_ALGORITHM, const char*> algorithms[] = {
+		{ MULTIPLICATION_ALGORITHM::SCHOOLBOOK, "schoolbook" },
+		{ MULTIPLICATION_ALGORITHM::KARATSUBA, "Karatsuba" },
+		{ MULTIPLICATION_ALGORITHM::TOOM3, "Toom-3" },
+		{ MULTIPLICATION_ALGORITHM::NTT, "NTT" }
+	};
+	std::mt19937 coefficients;
+	for (size_t length : { 32, 128, 512, 2048, 8192 })
+	{
+		std::vector<int> va(length), vb(length);
+		std::generate(va.begin(), va.end(), [&coefficients]() { return randmod([&coefficients]() { return coefficients(); }, NttPrime); });
+		std::generate(vb.begin(), vb.end(), [&coefficients]() { return randmod([&coefficients]() { return coefficients(); }, NttPrime); });
+		Polynomial<NttPrime> a = va, b = vb;
+		std::cout << "Multiplication with " << length << " coefficients over Z" << NttPrime << ":";
+		for (const auto& algorithm : algorithms)
+		{
+			NttMultiplier::Algorithm = algorithm.first;
+			const size_t repeats = 4096 * 4 / length;
+			auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < repeats; ++i)
+				a * b;
+			auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repeats;
+			std::cout << " " << algorithm.second << " " << elapsed << "us";
+		}
+		std::cout << std::endl;
+	}
+	NttMultiplier::Algorithm = MULTIPLICATION_ALGORITHM::AUTO;
+
+	// The same products with the modulus known only at runtime
+	auto time = [](const std::function<void()>& f, size_t repeats)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < repeats; ++i)
+			f();
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repeats;
+	};
+	constexpr const size_t Prime32 = 1000000007, Prime61 = (size_t(1) << 61) - 1;
+	for (size_t length : { 128, 2048 })
+	{
+		std::vector<int> va(length), vb(length);
+		std::generate(va.begin(), va.end(), [&coefficients]() { return int(coefficients() >> 1); });
+		std::generate(vb.begin(), vb.end(), [&coefficients]() { return int(coefficients() >> 1); });
+		std::vector<long long> la(va.begin(), va.end()), lb(vb.begin(), vb.end());
+		const size_t repeats = 4096 * 4 / length;
+
+		Polynomial<Prime32> a32 = va, b32 = vb;
+		Polynomial<Prime61> a61 = va, b61 = vb;
+		MontgomeryRing ring32(Prime32), ring61(Prime61);
+		RuntimePolynomial r32(ring32, la), s32(ring32, lb), r61(ring61, la), s61(ring61, lb);
+		std::cout << "Multiplication with " << length << " coefficients, compile-time vs runtime modulus:"
+			<< " Z" << Prime32 << " " << time([&]() { a32 * b32; }, repeats) << "us / " << time([&]() { r32 * s32; }, repeats) << "us"
+			<< " Z" << Prime61 << " " << time([&]() { a61 * b61; }, repeats) << "us / " << time([&]() { r61 * s61; }, repeats) << "us" << std::endl;
+	}
+
+	// Exponentiation is logarithmic: the time grows with the number of bits of the exponent, not its value
+	Polynomial<NttPrime> ntt_modulus = std::vector<int>(65, 1), ntt_base = { 3, 1, 4, 1, 5, 9, 2, 6 };
+	Polynomial<2> binary_modulus = Polynomial<2>::X.pow(256) + Polynomial<2>{ 1, 0, 1, 0, 0, 1, 0, 0, 0, 0, 1 }, binary_base = { 1, 1, 0, 1 };
+	for (size_t bits : { 8, 16, 32, 48, 63 })
+	{
+		size_t exponent = (size_t(1) << (bits - 1)) | (size_t(0x9E3779B97F4A7C15ull) >> (65 - bits));
+		std::cout << "Exponent of " << bits << " bits: powmod mod " << Prime61 << " " << time([&]() { powmod(3, exponent, Prime61); }, 4096) << "us"
+			<< ", PowMod mod degree 64 over Z" << NttPrime << " " << time([&]() { Polynomial<NttPrime>::PowMod(ntt_base, exponent, ntt_modulus); }, 16) << "us"
+			<< ", PowMod mod degree 256 over Z2 " << time([&]() { Polynomial<2>::PowMod(binary_base, exponent, binary_modulus); }, 16) << "us" << std::endl;
+	}
+	for (size_t length : { 128, 2048 })
+	{
+		std::vector<int> va(length);
+		std::generate(va.begin(), va.end(), [&coefficients]() { return int(coefficients() >> 1); });
+		Polynomial<NttPrime> a = va;
+		Polynomial<Prime61> a61 = va;
+		const size_t repeats = 4096 * 4 / length;
+		std::cout << "Squaring with " << length << " coefficients, a * a vs a.square():"
+			<< " Z" << NttPrime << " " << time([&]() { a * a; }, repeats) << "us / " << time([&]() { a.square(); }, repeats) << "us"
+			<< " Z" << Prime61 << " " << time([&]() { a61 * a61; }, repeats) << "us / " << time([&]() { a61.square(); }, repeats) << "us" << std::endl;
+	}
+
+	// Half-GCD is O(M(n) log n), the classical remainder sequence O(n^2)
+	for (size_t length : { 4096, 8192 })
+	{
+		std::vector<int> va(length), vb(length - 1);
+		std::generate(va.begin(), va.end(), [&coefficients]() { return int(coefficients() >> 1); });
+		std::generate(vb.begin(), vb.end(), [&coefficients]() { return int(coefficients() >> 1); });
+		Polynomial<NttPrime> a = va, b = vb;
+		std::cout << "Gcd with " << length << " coefficients over Z" << NttPrime << ": half-GCD " << time([&]() { Polynomial<NttPrime>::Gcd(a, b); }, 1) << "us";
+		size_t threshold = Euclid<ModularRing<NttPrime>>::HalfGcdThreshold;
+		Euclid<ModularRing<NttPrime>>::HalfGcdThreshold = length + 1;
+		std::cout << ", classical " << time([&]() { Polynomial<NttPrime>::Gcd(a, b); }, 1) << "us" << std::endl;
+		Euclid<ModularRing<NttPrime>>::HalfGcdThreshold = threshold;
+	}
+
+	// Allocations do not grow with the number of iterations: Gcd and divide allocate the same at any degree,
+	// BuildFactorGroup about once per element (the element itself)
+	bool allocations_bounded = true;
+	std::mt19937 allocation_coefficients;
+	auto random7 = [&allocation_coefficients](size_t n)
+	{
+		std::vector<int> v(n + 1);
+		std::generate(v.begin(), v.end(), [&allocation_coefficients]() { return int(allocation_coefficients() % 7); });
+		v[n] = 1;
+		return Polynomial<7>(v);
+	};
+	for (size_t length : { 100, 400 })
+	{
+		Polynomial<7> a = random7(length), b = random7(3 * length / 4);
+		size_t gcd_allocations = count_allocations([&]() { Polynomial<7>::Gcd(a, b); });
+		// divide returns two new polynomials, % only the remainder
+		size_t divide_allocations = count_allocations([&]() { a.divide(b); });
+		size_t remainder_allocations = count_allocations([&]() { a % b; });
+		std::cout << "Heap allocations with degree " << length << " over Z7: Gcd " << gcd_allocations
+			<< ", divide " << divide_allocations << ", % " << remainder_allocations << std::endl;
+		allocations_bounded = allocations_bounded && gcd_allocations <= 4 && divide_allocations <= 2 && remainder_allocations <= 1;
+	}
+	Polynomial<3> field_factor = GaloisFieldExtension<3, 7>::FindIrreducible(1);
+	size_t field_elements = 0;
+	size_t field_allocations = count_allocations([&]() { field_elements = GaloisFieldExtension<3, 7>::Build(field_factor, false).m_order(); });
+	std::cout << "Heap allocations building GF(3^7) with " << field_elements << " powers of the generator: " << field_allocations << std::endl;
+	allocations_bounded = allocations_bounded && field_allocations <= field_elements + 16;
+	if (!allocations_bounded)
+	{
+		std::cout << "Allocations grow with the number of iterations" << std::endl;
+		return 1;
+	}
+
 
 	return 0;
 };
\ No newline at end of file